@@ -0,0 +1,240 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       SimHardware.cpp                                           */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Host side physics model of the Min 6 drivetrain           */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <math.h>
+#include "SimHardware.h"
+
+static double WrapHeading(double Heading)
+{
+    Heading = fmod(Heading, 360.0);
+    if (Heading < 0) Heading += 360.0;
+    return Heading;
+}
+
+#pragma region SimDriveMotor
+void SimDriveMotor::Spin(double VelocityRPM)
+{
+    _commandRPM = VelocityRPM;
+    _braking = false;
+}
+
+void SimDriveMotor::Stop()
+{
+    _commandRPM = 0;
+    _braking = true;
+}
+
+double SimDriveMotor::Velocity()
+{
+    return _velocityRPM;
+}
+
+double SimDriveMotor::Position()
+{
+    return _positionDeg;
+}
+
+void SimDriveMotor::ResetPosition()
+{
+    _positionDeg = 0;
+}
+
+void SimDriveMotor::Step(double dt)
+{
+    const SimPlantParams &params = m_Plant.Params();
+    double target = _commandRPM * _scale;
+
+    //A sagging pack lowers the free speed and the torque: slower to accelerate, harder to break free
+    double supply = params.BatteryVolts / params.NominalBatteryVolts;
+    double maxRPM = params.MaxMotorRPM * supply;
+    double stallRPM = params.StallRPM / supply;
+    if (fabs(target) < params.MotorDeadbandRPM) target = 0;
+    if (target > maxRPM) target = maxRPM;
+    if (target < -maxRPM) target = -maxRPM;
+    //A stopped bot needs StallRPM to break free, a moving one keeps rolling below it
+    if ((fabs(_velocityRPM) < (stallRPM * 0.5)) && (fabs(target) < stallRPM)) target = 0;
+
+    double tau = _braking ? params.MotorBrakeTimeConstantSec : params.MotorTimeConstantSec / supply;
+    _velocityRPM += (target - _velocityRPM) * (1.0 - exp(-dt / tau));
+    _positionDeg += _velocityRPM * 6.0 * dt;
+}
+#pragma endregion
+
+#pragma region SimInertialSensor
+double SimInertialSensor::Measured()
+{
+    return m_Plant.TrueRotation() + _driftDeg + m_Plant.Noise(m_Plant.Params().GyroNoiseDeg);
+}
+
+void SimInertialSensor::Calibrate()
+{
+    _calibrationEndSec = m_Plant.TimeSec() + m_Plant.Params().GyroCalibrationSec;
+    _driftDeg = 0;
+    _headingReference = m_Plant.TrueRotation();
+    _rotationReference = m_Plant.TrueRotation();
+}
+
+bool SimInertialSensor::IsCalibrating()
+{
+    return m_Plant.TimeSec() < _calibrationEndSec;
+}
+
+double SimInertialSensor::Heading()
+{
+    if (IsCalibrating()) return 0;
+    return WrapHeading(Measured() - _headingReference);
+}
+
+double SimInertialSensor::Rotation()
+{
+    if (IsCalibrating()) return 0;
+    return Measured() - _rotationReference;
+}
+
+void SimInertialSensor::Step(double dt)
+{
+    if (!IsCalibrating()) _driftDeg += m_Plant.Params().GyroDriftDegPerSec * dt;
+}
+#pragma endregion
+
+#pragma region SimDistanceSensor
+void SimDistanceSensor::Update()
+{
+    const SimPlantParams &params = m_Plant.Params();
+    if ((_updateSec >= 0) && ((m_Plant.TimeSec() - _updateSec) < params.RangePeriodSec)) return;
+    _updateSec = m_Plant.TimeSec();
+
+    //Range along the heading to the wall face, lost when looking too far away from it
+    double cosHeading = cos(m_Plant.TrueRotation() * (M_PI / 180.0));
+    double range = (cosHeading > 0.5) ? (params.WallY - m_Plant.TrueSensorY()) / cosHeading : -1;
+    _detected = (range >= 0) && (range <= params.RangeMaxMm);
+    _rangeMm = _detected ? range + m_Plant.Noise(params.RangeNoiseMm) : 0;
+    if (_rangeMm < 0) _rangeMm = 0;
+}
+
+bool SimDistanceSensor::ObjectDetected()
+{
+    Update();
+    return _detected;
+}
+
+double SimDistanceSensor::ObjectDistanceMm()
+{
+    Update();
+    return _rangeMm;
+}
+#pragma endregion
+
+#pragma region SimOpticalSensor
+bool SimOpticalSensor::OverLine()
+{
+    const SimPlantParams &params = m_Plant.Params();
+    return fabs(m_Plant.TrueSensorY() - params.LineY) <= (params.LineWidthMm / 2.0);
+}
+
+double SimOpticalSensor::Hue()
+{
+    return OverLine() ? m_Plant.Params().LineHue : m_Plant.Params().FloorHue;
+}
+
+double SimOpticalSensor::Brightness()
+{
+    return OverLine() ? m_Plant.Params().LineBrightness : m_Plant.Params().FloorBrightness;
+}
+#pragma endregion
+
+#pragma region SimBrain
+uint64_t SimBrain::SystemTimeUs()
+{
+    return (uint64_t)(m_Plant.TimeSec() * 1000000.0 + 0.5);
+}
+
+void SimBrain::ResetTimer()
+{
+    _timerStartSec = m_Plant.TimeSec();
+}
+
+double SimBrain::TimerSec()
+{
+    return m_Plant.TimeSec() - _timerStartSec;
+}
+
+double SimBrain::BatteryVoltage()
+{
+    return m_Plant.Params().BatteryVolts;
+}
+
+void SimBrain::SleepMs(uint32_t TimeMs)
+{
+    m_Plant.Advance(TimeMs / 1000.0);
+}
+
+void SimBrain::SleepUntilUs(uint64_t DeadlineUs)
+{
+    uint64_t now = SystemTimeUs();
+    if (DeadlineUs > now) m_Plant.Advance((DeadlineUs - now) / 1000000.0);
+}
+#pragma endregion
+
+#pragma region SimPlant
+SimPlant::SimPlant(const SimPlantParams &Params)
+    : _params(Params)
+    , _random(Params.Seed)
+    , _gaussian(0.0, 1.0)
+    , _timeSec(0)
+    , _trueRotation(0)
+    , _trueX(0)
+    , _trueY(0)
+    , Brain(*this)
+    , Inertial(*this)
+    , RightMotor(*this, Params.RightMotorScale)
+    , LeftMotor(*this, Params.LeftMotorScale)
+    , Distance(*this)
+    , Optical(*this)
+{}
+
+double SimPlant::TrueHeading() const
+{
+    return WrapHeading(_trueRotation);
+}
+
+double SimPlant::TrueSensorY() const
+{
+    return _trueY + (_params.SensorOffsetMm * cos(_trueRotation * (M_PI / 180.0)));
+}
+
+void SimPlant::Step(double dt)
+{
+    RightMotor.Step(dt);
+    LeftMotor.Step(dt);
+    Inertial.Step(dt);
+
+    //Differential drive: mean wheel surface speed moves the center, the difference over the track width turns it
+    double mmPerSecPerRPM = ((double)_params.InGearSize / (double)_params.OutGearSize) * _params.WheelCircumference / 60.0;
+    double speed = (LeftMotor.TrueVelocity() + RightMotor.TrueVelocity()) * 0.5 * mmPerSecPerRPM;
+    double yawRate = (LeftMotor.TrueVelocity() - RightMotor.TrueVelocity()) * mmPerSecPerRPM / _params.TrackWidth;
+    double midHeading = (_trueRotation * (M_PI / 180.0)) + (yawRate * dt * 0.5);
+    _trueX += speed * sin(midHeading) * dt;
+    _trueY += speed * cos(midHeading) * dt;
+    _trueRotation += yawRate * (180.0 / M_PI) * dt;
+    _timeSec += dt;
+
+    if (_stepObserver) _stepObserver(*this);
+}
+
+void SimPlant::Advance(double Sec)
+{
+    double endSec = _timeSec + Sec;
+    while (_timeSec < (endSec - 1e-9))
+    {
+        double dt = endSec - _timeSec;
+        if (dt > _params.PhysicsStepSec) dt = _params.PhysicsStepSec;
+        Step(dt);
+    }
+}
+#pragma endregion
@@ -0,0 +1,253 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       SimHardware.h                                             */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Simulated brain, inertial sensor, motors and field        */
+/*                  sensors of the Min 6 drivetrain for the host tools        */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#ifndef Sim_Hardware
+#define Sim_Hardware
+
+#include <functional>
+#include <random>
+#include "DrivetrainHardware.h"
+
+/// @brief Physical constants of the simulated bot. Defaults approximate the Min 6 IQ2 bot.
+struct SimPlantParams
+{
+    double PhysicsStepSec;              //Integration step
+    double MotorTimeConstantSec;        //First order velocity response of a driven motor (bot inertia)
+    double MotorBrakeTimeConstantSec;   //Velocity response after Stop()
+    double MotorDeadbandRPM;            //Commands below this are ignored by the motor controller
+    double StallRPM;                    //Commands below this do not break a stopped bot free of static friction
+    double BatteryVolts;                //Pack voltage: motor torque, free speed and breakaway scale with it
+    double NominalBatteryVolts;         //Pack voltage the motor constants describe
+    double MaxMotorRPM;                 //Motor free speed
+    double LeftMotorScale;              //Achieved / commanded velocity of the left side (motor and wheel mismatch)
+    double RightMotorScale;             //Achieved / commanded velocity of the right side
+    double WheelCircumference;          //[mm]
+    int InGearSize;                     //Motor side gear tooth count
+    int OutGearSize;                    //Wheel side gear tooth count
+    double TrackWidth;                  //[mm] distance between left and right wheel contact lines
+    double GyroNoiseDeg;                //Standard deviation of every gyro reading
+    double GyroDriftDegPerSec;          //Constant gyro drift after calibration
+    double GyroCalibrationSec;          //Time the inertial sensor reports IsCalibrating()
+    double SensorOffsetMm;              //[mm] distance and optical sensors ahead of the bot center
+    double WallY;                       //[mm] wall across the field, y of its face, seen by the distance sensor
+    double RangeMaxMm;                  //Distance sensor reports no object beyond this range
+    double RangeNoiseMm;                //Standard deviation of every range reading
+    double RangePeriodSec;              //Distance sensor update period, readings hold in between
+    double LineY;                       //[mm] centre of a tape line across the field
+    double LineWidthMm;                 //Tape width
+    double LineHue;                     //[deg] tape hue seen by the optical sensor
+    double LineBrightness;              //[%] tape brightness
+    double FloorHue;                    //[deg] field tile hue
+    double FloorBrightness;             //[%] field tile brightness
+    unsigned int Seed;                  //Noise generator seed
+
+    SimPlantParams()
+        : PhysicsStepSec(0.001)
+        , MotorTimeConstantSec(0.08)
+        , MotorBrakeTimeConstantSec(0.03)
+        , MotorDeadbandRPM(1.0)
+        , StallRPM(4.0)
+        , BatteryVolts(8.0)
+        , NominalBatteryVolts(8.0)
+        , MaxMotorRPM(120.0)
+        , LeftMotorScale(1.0)
+        , RightMotorScale(1.0)
+        , WheelCircumference(230.0)
+        , InGearSize(48)
+        , OutGearSize(24)
+        , TrackWidth(170.0)
+        , GyroNoiseDeg(0.05)
+        , GyroDriftDegPerSec(0.01)
+        , GyroCalibrationSec(1.0)
+        , SensorOffsetMm(100.0)
+        , WallY(1500.0)
+        , RangeMaxMm(2000.0)
+        , RangeNoiseMm(2.0)
+        , RangePeriodSec(0.03)
+        , LineY(600.0)
+        , LineWidthMm(25.0)
+        , LineHue(0.0)
+        , LineBrightness(80.0)
+        , FloorHue(210.0)
+        , FloorBrightness(15.0)
+        , Seed(1)
+    {}
+};
+
+class SimPlant;
+
+/// @brief Simulated IQ smart motor driving one side of the bot
+class SimDriveMotor : public IDriveMotor
+{
+    private:
+        SimPlant &m_Plant;
+        double _scale;
+        double _commandRPM;
+        double _velocityRPM;
+        double _positionDeg;
+        bool _braking;
+
+    public:
+        SimDriveMotor(SimPlant &Plant, double Scale)
+            : m_Plant(Plant), _scale(Scale), _commandRPM(0), _velocityRPM(0), _positionDeg(0), _braking(true) {}
+
+        void Spin(double VelocityRPM);
+        void Stop();
+        double Velocity();
+        double Position();
+        void ResetPosition();
+
+        /// @brief Integrate the motor for one physics step
+        /// @param dt [sec] step length
+        void Step(double dt);
+
+        /// @brief Last commanded velocity
+        double CommandRPM() const { return _commandRPM; }
+
+        /// @brief Noise free motor velocity
+        double TrueVelocity() const { return _velocityRPM; }
+};
+
+/// @brief Simulated brain inertial sensor with noise and drift
+class SimInertialSensor : public IInertialSensor
+{
+    private:
+        SimPlant &m_Plant;
+        double _headingReference;
+        double _rotationReference;
+        double _driftDeg;
+        double _calibrationEndSec;
+
+        double Measured();
+
+    public:
+        SimInertialSensor(SimPlant &Plant)
+            : m_Plant(Plant), _headingReference(0), _rotationReference(0), _driftDeg(0), _calibrationEndSec(0) {}
+
+        void Calibrate();
+        bool IsCalibrating();
+        double Heading();
+        double Rotation();
+
+        /// @brief Accumulate gyro drift for one physics step
+        /// @param dt [sec] step length
+        void Step(double dt);
+};
+
+/// @brief Simulated distance sensor looking straight ahead at the wall at SimPlantParams::WallY
+class SimDistanceSensor : public IDistanceSensor
+{
+    private:
+        SimPlant &m_Plant;
+        bool _detected;
+        double _rangeMm;
+        double _updateSec;      //Time of the last reading, -1 before the first
+
+        void Update();
+
+    public:
+        SimDistanceSensor(SimPlant &Plant) : m_Plant(Plant), _detected(false), _rangeMm(0), _updateSec(-1) {}
+
+        bool ObjectDetected();
+        double ObjectDistanceMm();
+};
+
+/// @brief Simulated optical sensor looking down at the field, sees the tape line at SimPlantParams::LineY
+class SimOpticalSensor : public IOpticalSensor
+{
+    private:
+        SimPlant &m_Plant;
+
+        bool OverLine();
+
+    public:
+        SimOpticalSensor(SimPlant &Plant) : m_Plant(Plant) {}
+
+        double Hue();
+        double Brightness();
+};
+
+/// @brief Simulated brain. Sleeping advances simulated time instead of blocking.
+class SimBrain : public IBrainHardware
+{
+    private:
+        SimPlant &m_Plant;
+        double _timerStartSec;
+
+    public:
+        SimBrain(SimPlant &Plant) : m_Plant(Plant), _timerStartSec(0) {}
+
+        uint64_t SystemTimeUs();
+        void ResetTimer();
+        double TimerSec();
+        void SleepMs(uint32_t TimeMs);
+        void SleepUntilUs(uint64_t DeadlineUs);
+        void ScreenClear() {}
+        void ScreenClearLine(int) {}
+        void ScreenPrintAt(int, int, const char *) {}
+        double BatteryVoltage();
+};
+
+/// @brief Simulated six wheel differential drivetrain. Owns the simulated hardware handed to Min6AutoDrivetrain.
+class SimPlant
+{
+    private:
+        SimPlantParams _params;
+        std::mt19937 _random;
+        std::normal_distribution<double> _gaussian;
+        double _timeSec;
+        double _trueRotation;
+        double _trueX;
+        double _trueY;
+        std::function<void(const SimPlant &)> _stepObserver;
+
+        void Step(double dt);
+
+    public:
+        SimBrain Brain;
+        SimInertialSensor Inertial;
+        SimDriveMotor RightMotor;
+        SimDriveMotor LeftMotor;
+        SimDistanceSensor Distance;
+        SimOpticalSensor Optical;
+
+        SimPlant(const SimPlantParams &Params = SimPlantParams());
+
+        /// @brief Run the physics forward
+        /// @param Sec [sec] simulated time to advance
+        void Advance(double Sec);
+
+        /// @brief Call Observer after every physics step
+        void SetStepObserver(const std::function<void(const SimPlant &)> &Observer) { _stepObserver = Observer; }
+
+        /// @brief Place the bot at a rotation without moving it
+        /// @param Rotation [deg] true clockwise rotation, the gyro keeps reading relative to its calibration
+        void SetTrueRotation(double Rotation) { _trueRotation = Rotation; }
+
+        /// @brief Zero mean gaussian sample
+        /// @param StdDev standard deviation
+        double Noise(double StdDev) { return (StdDev > 0) ? _gaussian(_random) * StdDev : 0; }
+
+        const SimPlantParams &Params() const { return _params; }
+        double TimeSec() const { return _timeSec; }
+
+        /// @brief Noise free clockwise rotation of the bot
+        double TrueRotation() const { return _trueRotation; }
+
+        /// @brief Noise free heading of the bot in [0, 360)
+        double TrueHeading() const;
+
+        /// @brief Noise free position of the bot center, x to the right and y forward of the start heading
+        double TrueX() const { return _trueX; }
+        double TrueY() const { return _trueY; }
+
+        /// @brief Noise free position of the front sensors along y
+        double TrueSensorY() const;
+};
+#endif
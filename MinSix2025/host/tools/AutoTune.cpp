@@ -0,0 +1,84 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       AutoTune.cpp                                              */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Runs the relay feedback auto-tuner against the            */
+/*                  simulated drivetrain and prints the measured ultimate     */
+/*                  gain and period with the resulting gains                  */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SimHardware.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+
+static void PrintUsage()
+{
+    printf("usage: autotune [-drive] [-relay rpm] [-hyst band] [-cycles n] [-rule fast|noovershoot] [-mismatch fraction] [-seed n]\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool drive = false;
+    double relayRPM = 20.0;
+    double hysteresis = -1;
+    int cycles = 6;
+    Min6AutoDrivetrain::TuneRules rule = Min6AutoDrivetrain::TuneRules::Fast;
+    double mismatch = 0.0;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-drive") == 0) drive = true;
+        else if ((strcmp(argv[i], "-relay") == 0) && (i + 1 < argc)) relayRPM = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-hyst") == 0) && (i + 1 < argc)) hysteresis = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-cycles") == 0) && (i + 1 < argc)) cycles = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-mismatch") == 0) && (i + 1 < argc)) mismatch = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-seed") == 0) && (i + 1 < argc)) seed = (unsigned int)atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-rule") == 0) && (i + 1 < argc))
+        {
+            i++;
+            if (strcmp(argv[i], "fast") == 0) rule = Min6AutoDrivetrain::TuneRules::Fast;
+            else if (strcmp(argv[i], "noovershoot") == 0) rule = Min6AutoDrivetrain::TuneRules::NoOvershoot;
+            else
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (hysteresis < 0) hysteresis = drive ? 2.0 : 0.5;
+
+    SimPlantParams params;
+    params.LeftMotorScale = 1.0 + (mismatch / 2.0);
+    params.RightMotorScale = 1.0 - (mismatch / 2.0);
+    params.Seed = seed;
+    SimPlant plant(params);
+    Min6AutoDrivetrain drivetrain(plant.Brain, plant.Inertial, plant.RightMotor, plant.LeftMotor, gMinSixConfig);
+    drivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::None);
+
+    AutoTuneResult result = drive
+                          ? drivetrain.AutoTuneDrive(relayRPM, rule, hysteresis, cycles)
+                          : drivetrain.AutoTuneTurn(relayRPM, rule, hysteresis, cycles);
+
+    printf("%s axis, relay %.1f RPM, hysteresis %.2f %s, %s rule\n", drive ? "Drive" : "Turn", relayRPM, hysteresis, drive ? "mm" : "deg",
+        (rule == Min6AutoDrivetrain::TuneRules::Fast) ? "fast" : "no overshoot");
+    if (!result.Valid)
+    {
+        printf("No steady oscillation measured\n");
+        return 1;
+    }
+    printf("Ku %.4f RPM/%s, Pu %.3f s, amplitude %.3f %s\n", result.UltimateGain, drive ? "mm" : "deg", result.UltimatePeriod, result.Amplitude, drive ? "mm" : "deg");
+    printf("Kp %.4f, Ki %.4f, Kd %.4f\n", result.Kp, result.Ki, result.Kd);
+    printf("check: ./build/turn_bench %s-kp %.4f -ki %.4f -kd %.4f\n", drive ? "-drive " : "", result.Kp, result.Ki, result.Kd);
+
+    return 0;
+}
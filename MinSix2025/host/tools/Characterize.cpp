@@ -0,0 +1,76 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       Characterize.cpp                                          */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Runs the feedforward characterization against the        */
+/*                  simulated drivetrain and prints the fitted kS, kV and     */
+/*                  kA next to the values the drive geometry predicts         */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "SimHardware.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+
+static void PrintUsage()
+{
+    printf("usage: characterize [-drive] [-max rpm] [-ramp rpm/sec] [-mismatch fraction] [-seed n]\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool drive = false;
+    double maxRPM = 60.0;
+    double rampRPMPerSec = 20.0;
+    double mismatch = 0.0;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-drive") == 0) drive = true;
+        else if ((strcmp(argv[i], "-max") == 0) && (i + 1 < argc)) maxRPM = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-ramp") == 0) && (i + 1 < argc)) rampRPMPerSec = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-mismatch") == 0) && (i + 1 < argc)) mismatch = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-seed") == 0) && (i + 1 < argc)) seed = (unsigned int)atoi(argv[++i]);
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    SimPlantParams params;
+    params.LeftMotorScale = 1.0 + (mismatch / 2.0);
+    params.RightMotorScale = 1.0 - (mismatch / 2.0);
+    params.Seed = seed;
+    SimPlant plant(params);
+    Min6AutoDrivetrain drivetrain(plant.Brain, plant.Inertial, plant.RightMotor, plant.LeftMotor, gMinSixConfig);
+    drivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::None);
+
+    FeedforwardResult result = drive
+                             ? drivetrain.CharacterizeDrive(maxRPM, rampRPMPerSec)
+                             : drivetrain.CharacterizeTurn(maxRPM, rampRPMPerSec);
+
+    //Ideal wheels: motor RPM per unit of bot speed from the simulated geometry
+    double mmPerSecPerRPM = ((double)params.InGearSize / (double)params.OutGearSize) * params.WheelCircumference / 60.0;
+    double geometricKv = drive ? (1.0 / mmPerSecPerRPM) : (((M_PI / 180.0) * (params.TrackWidth / 2.0)) / mmPerSecPerRPM);
+    double geometricKa = geometricKv * params.MotorTimeConstantSec;
+
+    printf("%s axis, ramp %.1f RPM/s to %.1f RPM, step %.1f RPM\n", drive ? "Drive" : "Turn", rampRPMPerSec, maxRPM, -maxRPM);
+    if (!result.Valid)
+    {
+        printf("No feedforward fit from %d moving samples\n", result.Samples);
+        return 1;
+    }
+    printf("kS %.3f RPM (sim breakaway %.3f)\n", result.Ks, params.StallRPM);
+    printf("kV %.5f RPM per %s/s (geometry %.5f)\n", result.Kv, drive ? "mm" : "deg", geometricKv);
+    printf("kA %.6f RPM per %s/s^2 (motor lag %.6f)\n", result.Ka, drive ? "mm" : "deg", geometricKa);
+    printf("%d moving samples\n", result.Samples);
+    printf("check: ./build/turn_bench %s-ks %.4f -kv %.5f -ka %.6f\n", drive ? "-drive " : "", result.Ks, result.Kv, result.Ka);
+
+    return 0;
+}
@@ -0,0 +1,368 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       TelemetryReport.cpp                                       */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Reads Verbose console captures from the brain (or the     */
+/*                  simulator) one line at a time and reports turn metrics,   */
+/*                  RPM tracking and loop timing per capture, side by side    */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//Loop period buckets as a multiple of the nominal period
+static const double gPeriodEdges[] = { 0.9, 1.1, 1.5, 2.0 };
+static const int PeriodBuckets = (sizeof(gPeriodEdges) / sizeof(gPeriodEdges[0])) + 1;
+static const char *gPeriodNames[PeriodBuckets] = { "<0.9P", "0.9-1.1P", "1.1-1.5P", "1.5-2P", ">2P" };
+
+enum MotionKinds
+{
+    KindTurn,
+    KindDrive,
+    KindOther
+};
+
+struct Options
+{
+    double SettleBand;      //[deg] a turn is settled once its error stays inside this band
+    double PeriodMs;        //[ms] nominal control period
+    bool Turns;             //Print every turn as well as the run summary
+    bool Csv;
+};
+
+/// @brief Running metrics of one motion, updated a tick at a time
+struct MotionStats
+{
+    unsigned int Id;
+    MotionKinds Kind;
+    double Target;
+    int Ticks;
+    double TurnAmount;      //[deg] signed turn from the first tick's heading to the target
+    double LastSec;
+    double Rise10Sec;       //First time 10% of the turn was covered, -1 before
+    double Rise90Sec;       //First time 90% of the turn was covered, -1 before
+    double OvershootDeg;
+    double LastOutsideSec;  //Last tick with the error outside the settle band, -1 if none
+    bool EndedOutside;
+    double FinalErrorDeg;
+    double TrackSumSq;
+    double TrackMax;
+};
+
+/// @brief Totals of one capture, the row of the comparison table
+struct RunStats
+{
+    const char *Name;
+    int Motions;
+    int Turns;
+    int Unsettled;
+    int RiseCount;
+    double RiseSum;
+    double OvershootSum;
+    double OvershootMax;
+    double SettleSum;
+    double FinalErrorSum;
+    double FinalErrorMax;
+    int TrackTicks;
+    double TrackSumSq;
+    double TrackMax;
+    int Periods;
+    double PeriodSumMs;
+    double PeriodMaxMs;
+    int PeriodHistogram[PeriodBuckets];
+    int Overruns;
+    int Dropped;
+};
+
+/// @brief Signed shortest angle from one heading to another, positive clockwise
+static double HeadingError(double Target, double Current)
+{
+    double error = fmod(Target - Current, 360.0);
+    if (error > 180.0) error -= 360.0;
+    if (error <= -180.0) error += 360.0;
+    return error;
+}
+
+static void StartMotion(MotionStats &Motion, unsigned int Id, double Target, MotionKinds Kind)
+{
+    memset(&Motion, 0, sizeof(Motion));
+    Motion.Id = Id;
+    Motion.Kind = Kind;
+    Motion.Target = Target;
+    Motion.Rise10Sec = -1;
+    Motion.Rise90Sec = -1;
+    Motion.LastOutsideSec = -1;
+}
+
+/// @brief Fold one telemetry row into its motion and run
+static void AddTick(MotionStats &Motion, RunStats &Run, const Options &Opts,
+                    double TimeSec, double CommandRPM, double RightRPM, double LeftRPM, double Heading, double Rotation, int Overrun)
+{
+    if (Motion.Ticks > 0)
+    {
+        double periodMs = (TimeSec - Motion.LastSec) * 1000.0;
+        int bucket = 0;
+        while ((bucket < (PeriodBuckets - 1)) && (periodMs >= (gPeriodEdges[bucket] * Opts.PeriodMs))) bucket++;
+        Run.PeriodHistogram[bucket]++;
+        Run.Periods++;
+        Run.PeriodSumMs += periodMs;
+        if (periodMs > Run.PeriodMaxMs) Run.PeriodMaxMs = periodMs;
+    }
+    if (Overrun) Run.Overruns++;
+
+    //Turns command +RPM on the left and -RPM on the right, drives the same RPM on both
+    if (Motion.Kind != KindOther)
+    {
+        double actual = (Motion.Kind == KindTurn) ? ((LeftRPM - RightRPM) / 2.0) : ((LeftRPM + RightRPM) / 2.0);
+        double error = CommandRPM - actual;
+        Motion.TrackSumSq += error * error;
+        if (fabs(error) > Motion.TrackMax) Motion.TrackMax = fabs(error);
+    }
+
+    if (Motion.Kind == KindTurn)
+    {
+        //Rotation is measured from the start of the motion, so the first tick gives the starting heading
+        if (Motion.Ticks == 0) Motion.TurnAmount = HeadingError(Motion.Target, Heading - Rotation);
+        double error = Motion.TurnAmount - Rotation;
+        if (Motion.TurnAmount != 0)
+        {
+            double progress = Rotation / Motion.TurnAmount;
+            if ((Motion.Rise10Sec < 0) && (progress >= 0.1)) Motion.Rise10Sec = TimeSec;
+            if ((Motion.Rise90Sec < 0) && (progress >= 0.9)) Motion.Rise90Sec = TimeSec;
+            double past = (Motion.TurnAmount > 0) ? -error : error;
+            if (past > Motion.OvershootDeg) Motion.OvershootDeg = past;
+        }
+        Motion.EndedOutside = fabs(error) > Opts.SettleBand;
+        if (Motion.EndedOutside) Motion.LastOutsideSec = TimeSec;
+        Motion.FinalErrorDeg = error;
+    }
+
+    Motion.LastSec = TimeSec;
+    Motion.Ticks++;
+}
+
+/// @brief Close a motion: fold its metrics into the run and print it if asked
+static void EndMotion(MotionStats &Motion, RunStats &Run, const Options &Opts)
+{
+    if (Motion.Ticks == 0) return;
+    Run.Motions++;
+    if (Motion.Kind != KindOther)
+    {
+        Run.TrackTicks += Motion.Ticks;
+        Run.TrackSumSq += Motion.TrackSumSq;
+        if (Motion.TrackMax > Run.TrackMax) Run.TrackMax = Motion.TrackMax;
+    }
+    if (Motion.Kind != KindTurn)
+    {
+        Motion.Ticks = 0;
+        return;
+    }
+
+    double rise = ((Motion.Rise10Sec >= 0) && (Motion.Rise90Sec >= 0)) ? (Motion.Rise90Sec - Motion.Rise10Sec) : -1;
+    double settle = Motion.EndedOutside ? -1 : ((Motion.LastOutsideSec < 0) ? 0 : Motion.LastOutsideSec + (Opts.PeriodMs / 1000.0));
+    double trackRms = sqrt(Motion.TrackSumSq / Motion.Ticks);
+    Run.Turns++;
+    if (rise >= 0)
+    {
+        Run.RiseSum += rise;
+        Run.RiseCount++;
+    }
+    Run.OvershootSum += Motion.OvershootDeg;
+    if (Motion.OvershootDeg > Run.OvershootMax) Run.OvershootMax = Motion.OvershootDeg;
+    if (settle < 0) Run.Unsettled++;
+    else Run.SettleSum += settle;
+    Run.FinalErrorSum += fabs(Motion.FinalErrorDeg);
+    if (fabs(Motion.FinalErrorDeg) > Run.FinalErrorMax) Run.FinalErrorMax = fabs(Motion.FinalErrorDeg);
+
+    if (Opts.Turns)
+    {
+        if (Opts.Csv)
+            printf("%s, %u, %f, %f, %f, %f, %f, %f, %f, %d\n", Run.Name, Motion.Id, Motion.Target, Motion.TurnAmount,
+                rise, Motion.OvershootDeg, settle, Motion.FinalErrorDeg, trackRms, Motion.Ticks);
+        else
+            printf("%-20s %6u %8.1f %8.2f %8.3f %9.2f %8.3f %8.2f %9.2f %6d\n", Run.Name, Motion.Id, Motion.Target, Motion.TurnAmount,
+                rise, Motion.OvershootDeg, settle, Motion.FinalErrorDeg, trackRms, Motion.Ticks);
+    }
+    Motion.Ticks = 0;
+}
+
+/// @brief Stream one capture line by line. Only the open motion is kept in memory.
+/// @return [bool] false if the file could not be opened
+static bool ReadCapture(const char *Path, RunStats &Run, const Options &Opts)
+{
+    FILE *file = (strcmp(Path, "-") == 0) ? stdin : fopen(Path, "r");
+    if (file == 0)
+    {
+        fprintf(stderr, "Cannot open %s\n", Path);
+        return false;
+    }
+
+    MotionStats motion;
+    StartMotion(motion, 0, 0, KindOther);
+    char line[512];
+    while (fgets(line, sizeof(line), file) != 0)
+    {
+        double t, command, right, left, heading, rotation;
+        int overrun;
+        unsigned int id;
+        double target;
+        char kind[16];
+        int dropped;
+        if (sscanf(line, "%lf, %lf, %lf, %lf, %lf, %lf, %d", &t, &command, &right, &left, &heading, &rotation, &overrun) == 7)
+            AddTick(motion, Run, Opts, t, command, right, left, heading, rotation, overrun);
+        else if (strncmp(line, "Telemetry Motion", 16) == 0)
+        {
+            //Captures from before the Kind column are all turns
+            int fields = sscanf(line, "Telemetry Motion %u, Target %lf, Kind %15s", &id, &target, kind);
+            if (fields < 2) continue;
+            MotionKinds motionKind = KindTurn;
+            if (fields == 3) motionKind = (strcmp(kind, "Turn") == 0) ? KindTurn : ((strcmp(kind, "Drive") == 0) ? KindDrive : KindOther);
+            EndMotion(motion, Run, Opts);
+            StartMotion(motion, id, target, motionKind);
+        }
+        else if (sscanf(line, "Telemetry dropped %d records", &dropped) == 1)
+            Run.Dropped += dropped;
+    }
+    EndMotion(motion, Run, Opts);
+
+    if (file != stdin) fclose(file);
+    return true;
+}
+
+static double Mean(double Sum, int Count)
+{
+    return (Count > 0) ? (Sum / Count) : 0;
+}
+
+static void PrintRuns(RunStats *Runs, int Count, const Options &Opts)
+{
+    if (Opts.Csv)
+    {
+        printf("Run, Motions, Turns, Rise, Overshoot, MaxOvershoot, Settle, Unsettled, FinalError, MaxFinalError, TrackRms, TrackMax, PeriodMs, MaxPeriodMs, Overruns, Dropped");
+        for (int b = 0; b < PeriodBuckets; b++) printf(", %s", gPeriodNames[b]);
+        printf("\n");
+    }
+    else
+    {
+        printf("%-20s %5s %8s %9s %8s %8s %5s %8s %8s %8s %8s %7s %7s %6s %6s\n", "Run", "Turns", "Rise(s)", "Overshoot", "MaxOver",
+            "Settle(s)", "Unset", "|FinErr|", "MaxErr", "TrackRMS", "TrackMax", "Per(ms)", "MaxPer", "Overrn", "Drop");
+    }
+    for (int i = 0; i < Count; i++)
+    {
+        RunStats &run = Runs[i];
+        int settled = run.Turns - run.Unsettled;
+        double trackRms = (run.TrackTicks > 0) ? sqrt(run.TrackSumSq / run.TrackTicks) : 0;
+        if (Opts.Csv)
+        {
+            printf("%s, %d, %d, %f, %f, %f, %f, %d, %f, %f, %f, %f, %f, %f, %d, %d", run.Name, run.Motions, run.Turns,
+                Mean(run.RiseSum, run.RiseCount), Mean(run.OvershootSum, run.Turns), run.OvershootMax, Mean(run.SettleSum, settled), run.Unsettled,
+                Mean(run.FinalErrorSum, run.Turns), run.FinalErrorMax, trackRms, run.TrackMax,
+                Mean(run.PeriodSumMs, run.Periods), run.PeriodMaxMs, run.Overruns, run.Dropped);
+            for (int b = 0; b < PeriodBuckets; b++) printf(", %d", run.PeriodHistogram[b]);
+            printf("\n");
+        }
+        else
+        {
+            printf("%-20s %5d %8.3f %9.2f %8.2f %8.3f %5d %8.2f %8.2f %8.2f %8.2f %7.2f %7.2f %6d %6d\n", run.Name, run.Turns,
+                Mean(run.RiseSum, run.RiseCount), Mean(run.OvershootSum, run.Turns), run.OvershootMax, Mean(run.SettleSum, settled), run.Unsettled,
+                Mean(run.FinalErrorSum, run.Turns), run.FinalErrorMax, trackRms, run.TrackMax,
+                Mean(run.PeriodSumMs, run.Periods), run.PeriodMaxMs, run.Overruns, run.Dropped);
+        }
+    }
+    if (Opts.Csv) return;
+
+    //Loop period histograms
+    printf("\nLoop periods, nominal P = %.1f ms\n%-20s", Opts.PeriodMs, "Run");
+    for (int b = 0; b < PeriodBuckets; b++) printf(" %9s", gPeriodNames[b]);
+    printf("\n");
+    for (int i = 0; i < Count; i++)
+    {
+        printf("%-20s", Runs[i].Name);
+        for (int b = 0; b < PeriodBuckets; b++) printf(" %9d", Runs[i].PeriodHistogram[b]);
+        printf("\n");
+    }
+
+    //Every later run against the first
+    if (Count < 2) return;
+    RunStats &base = Runs[0];
+    printf("\nChange against %s\n", base.Name);
+    printf("%-20s %9s %10s %10s %10s\n", "Run", "Rise(s)", "Overshoot", "Settle(s)", "TrackRMS");
+    double baseSettle = Mean(base.SettleSum, base.Turns - base.Unsettled);
+    double baseTrack = (base.TrackTicks > 0) ? sqrt(base.TrackSumSq / base.TrackTicks) : 0;
+    for (int i = 1; i < Count; i++)
+    {
+        RunStats &run = Runs[i];
+        double track = (run.TrackTicks > 0) ? sqrt(run.TrackSumSq / run.TrackTicks) : 0;
+        printf("%-20s %+9.3f %+10.2f %+10.3f %+10.2f\n", run.Name,
+            Mean(run.RiseSum, run.RiseCount) - Mean(base.RiseSum, base.RiseCount),
+            Mean(run.OvershootSum, run.Turns) - Mean(base.OvershootSum, base.Turns),
+            Mean(run.SettleSum, run.Turns - run.Unsettled) - baseSettle,
+            track - baseTrack);
+    }
+}
+
+static void PrintUsage()
+{
+    printf("usage: telemetry_report [-band deg] [-period ms] [-turns] [-csv] capture [capture ...]\n");
+    printf("       a capture is a Verbose console log, - reads stdin\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    opts.SettleBand = 1.0;
+    opts.PeriodMs = 20.0;
+    opts.Turns = false;
+    opts.Csv = false;
+
+    int first = argc;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-band") == 0) && (i + 1 < argc)) opts.SettleBand = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-period") == 0) && (i + 1 < argc)) opts.PeriodMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "-turns") == 0) opts.Turns = true;
+        else if (strcmp(argv[i], "-csv") == 0) opts.Csv = true;
+        else if ((argv[i][0] == '-') && (argv[i][1] != 0))
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+        {
+            first = i;
+            break;
+        }
+    }
+    int count = argc - first;
+    if (count <= 0)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    RunStats *runs = (RunStats *)calloc(count, sizeof(RunStats));
+    if (opts.Turns)
+    {
+        if (opts.Csv)
+            printf("Run, Motion, Target, Turn, Rise, Overshoot, Settle, FinalError, TrackRms, Ticks\n");
+        else
+            printf("%-20s %6s %8s %8s %8s %9s %8s %8s %9s %6s\n", "Run", "Motion", "Target", "Turn", "Rise(s)", "Overshoot", "Settle(s)", "FinalErr", "TrackRMS", "Ticks");
+    }
+    for (int i = 0; i < count; i++)
+    {
+        runs[i].Name = argv[first + i];
+        if (!ReadCapture(argv[first + i], runs[i], opts))
+        {
+            free(runs);
+            return 1;
+        }
+    }
+    if (opts.Turns) printf("\n");
+    PrintRuns(runs, count, opts);
+    free(runs);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       TickBench.cpp                                             */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Times the per tick controller kernels natively, stores    */
+/*                  the results as a baseline file and flags kernels that     */
+/*                  got slower than a stored baseline                         */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "TickBenchmark.h"
+
+/// @brief Wall clock time source for the benchmark, the simulator brain runs on virtual time
+class HostClock : public IBrainHardware
+{
+    private:
+        std::chrono::steady_clock::time_point _start;
+        std::chrono::steady_clock::time_point _timerStart;
+
+    public:
+        HostClock() : _start(std::chrono::steady_clock::now()), _timerStart(_start) {}
+
+        uint64_t SystemTimeUs()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+        }
+        void ResetTimer() { _timerStart = std::chrono::steady_clock::now(); }
+        double TimerSec() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - _timerStart).count(); }
+        void SleepMs(uint32_t TimeMs) { std::this_thread::sleep_for(std::chrono::milliseconds(TimeMs)); }
+        void SleepUntilUs(uint64_t DeadlineUs)
+        {
+            uint64_t now = SystemTimeUs();
+            if (DeadlineUs > now) std::this_thread::sleep_for(std::chrono::microseconds(DeadlineUs - now));
+        }
+        void ScreenClear() {}
+        void ScreenClearLine(int Row) { (void)Row; }
+        void ScreenPrintAt(int Row, int Column, const char *Text) { (void)Row; (void)Column; (void)Text; }
+        double BatteryVoltage() { return 0; }
+};
+
+static const int MaxBaselines = 32;
+static char gBaselineNames[MaxBaselines][32];
+
+/// @brief Read "name ns_per_tick" lines, # starts a comment
+/// @return [int] baselines read, -1 if the file could not be opened
+static int LoadBaselines(const char *Path, TickBenchmarkBaseline *Baselines)
+{
+    FILE *file = fopen(Path, "r");
+    if (file == 0) return -1;
+    int count = 0;
+    char line[128];
+    while ((count < MaxBaselines) && (fgets(line, sizeof(line), file) != 0))
+    {
+        if (line[0] == '#') continue;
+        double ns = 0;
+        if (sscanf(line, "%31s %lf", gBaselineNames[count], &ns) != 2) continue;
+        Baselines[count].Name = gBaselineNames[count];
+        Baselines[count].NsPerTick = ns;
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+static bool SaveBaselines(const char *Path, TickBenchmark &Bench)
+{
+    FILE *file = fopen(Path, "w");
+    if (file == 0) return false;
+    fprintf(file, "# kernel ns_per_tick\n");
+    for (int r = 0; r < Bench.GET_ResultCount(); r++)
+        fprintf(file, "%s %.2f\n", Bench.GET_Result(r).Name, Bench.GET_Result(r).NsPerTick);
+    fclose(file);
+    return true;
+}
+
+static void PrintUsage()
+{
+    printf("usage: tick_bench [-ticks n] [-runs n] [-baseline file] [-tolerance percent] [-save file] [-table] [-phases]\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 1000000;
+    int runs = 5;
+    double tolerance = 10.0;
+    const char *baselinePath = 0;
+    const char *savePath = 0;
+    bool table = false;
+    bool phases = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-ticks") == 0) && (i + 1 < argc)) ticks = (uint32_t)atol(argv[++i]);
+        else if ((strcmp(argv[i], "-runs") == 0) && (i + 1 < argc)) runs = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-baseline") == 0) && (i + 1 < argc)) baselinePath = argv[++i];
+        else if ((strcmp(argv[i], "-tolerance") == 0) && (i + 1 < argc)) tolerance = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-save") == 0) && (i + 1 < argc)) savePath = argv[++i];
+        else if (strcmp(argv[i], "-table") == 0) table = true;
+        else if (strcmp(argv[i], "-phases") == 0) phases = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if ((ticks < 100) || (runs < 1))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    TickBenchmarkBaseline baselines[MaxBaselines];
+    int baselineCount = 0;
+    if (baselinePath != 0)
+    {
+        baselineCount = LoadBaselines(baselinePath, baselines);
+        if (baselineCount < 0)
+        {
+            printf("Cannot read baseline %s\n", baselinePath);
+            return 1;
+        }
+    }
+
+    HostClock clock;
+    static TickBenchmark bench(clock);
+    bench.Run(ticks, runs);
+    printf("Ticks %u, runs %d, best run kept\n", ticks, runs);
+    int regressions = bench.Report(baselines, baselineCount, tolerance / 100.0);
+    if (table) bench.PrintBaselineTable();
+    if (phases) bench.PrintLoopProfile();
+
+    if ((savePath != 0) && !SaveBaselines(savePath, bench))
+    {
+        printf("Cannot write baseline %s\n", savePath);
+        return 1;
+    }
+    if (regressions > 0)
+    {
+        printf("%d kernel(s) more than %.0f%% slower than the baseline\n", regressions, tolerance);
+        return 2;
+    }
+    return 0;
+}
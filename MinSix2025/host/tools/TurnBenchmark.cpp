@@ -0,0 +1,621 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       TurnBenchmark.cpp                                         */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Runs TurnToHeading (DriveDistance, DriveUntil or a        */
+/*                  routine to a corner) against the simulated drivetrain     */
+/*                  over a grid of targets and velocities and reports timing, */
+/*                  or checks that async motions stop when cancelled          */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "SimHardware.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+
+static const double gHeadings[] = { 10.0, 45.0, 90.0, 135.0, 180.0, 225.0, 270.0, 315.0, 350.0 };
+static const double gDistances[] = { 100.0, 300.0, 600.0, 900.0, -300.0 };
+static const double gVelocities[] = { 25.0, 50.0, 75.0, 100.0 };
+static const double gWallDistances[] = { 400.0, 800.0, 1500.0 };   //-sensor: wall face ahead of the start for the standoff runs
+static const double gLineDistances[] = { 300.0, 600.0, 900.0 };    //-sensor: tape line ahead of the start for the line runs
+static const double gStandoffMm = 150.0;
+static const double gArcRadius = 200.0;                             //-path: radius of the arc route
+static const double gLookahead = 150.0;                             //-path: pure pursuit lookahead
+static const PathPoint gCornerPath[] = { { 0.0, 600.0 }, { 600.0, 600.0 } };
+
+struct TurnResult
+{
+    double DoneSec;         //TurnToHeading returned
+    double ToHeadingSec;    //First time inside the heading tolerance, -1 if never
+    double SettleSec;       //Time after which the error stays inside the settle band, -1 if never
+    double OvershootDeg;    //Largest travel past the target
+    double FinalErrorDeg;   //Error after the bot has come to rest
+    double WallUs;          //Host time spent simulating the turn
+};
+
+/// @brief Signed shortest angle from Heading to Target
+static double HeadingError(double Target, double Heading)
+{
+    double error = fmod(Target - Heading, 360.0);
+    if (error > 180.0) error -= 360.0;
+    if (error <= -180.0) error += 360.0;
+    return error;
+}
+
+static double WrapHeading(double Heading)
+{
+    Heading = fmod(Heading, 360.0);
+    if (Heading < 0) Heading += 360.0;
+    return Heading;
+}
+
+struct TurnGains
+{
+    double Kp, Ki, Kd;
+    double Ks, Kv, Ka;      //Feedforward, Kv 0 uses the drive geometry
+};
+
+//-log: Verbose drivetrain output, a capture for telemetry_report
+static Min6AutoDrivetrain::LogLevels gLogLevel = Min6AutoDrivetrain::LogLevels::None;
+//-battery: simulated pack voltage, -nocomp: battery compensation off. The gains are tuned at 8V.
+static double gBatteryVolts = 8.0;
+static bool gBatteryCompensation = true;
+
+/// @brief Min 6 drivetrain on the simulated plant with the bench log level and battery compensation, gains left to the caller
+static std::unique_ptr<Min6AutoDrivetrain> MakeDrivetrain(SimPlant &Plant)
+{
+    std::unique_ptr<Min6AutoDrivetrain> drivetrain(new Min6AutoDrivetrain(Plant.Brain, Plant.Inertial, Plant.RightMotor, Plant.LeftMotor, gMinSixConfig));
+    drivetrain->Set_LogLevel(gLogLevel);
+    if (gBatteryCompensation) drivetrain->Set_BATTERY_COMPENSATION(8.0, 6.5);
+    return drivetrain;
+}
+
+static TurnResult RunTurn(const TurnGains &Gains, double StartHeading, double Heading, double Velocity, double Tolerance, double SettleBand, double TimeOut)
+{
+    SimPlantParams params;
+    params.BatteryVolts = gBatteryVolts;
+    SimPlant plant(params);
+    plant.SetTrueRotation(StartHeading);
+    std::unique_ptr<Min6AutoDrivetrain> drivetrain = MakeDrivetrain(plant);
+    drivetrain->Set_TURN_PID(Gains.Kp, Gains.Ki, Gains.Kd);
+    drivetrain->Set_TURN_FEEDFORWARD(Gains.Ks, Gains.Kv, Gains.Ka);
+
+    TurnResult result;
+    result.ToHeadingSec = -1;
+    result.SettleSec = 0;
+    result.OvershootDeg = 0;
+    double startSec = plant.TimeSec();
+    double startRotation = plant.TrueRotation();
+    double maxTravel = 0;
+    double minTravel = 0;
+
+    plant.SetStepObserver([&](const SimPlant &p)
+    {
+        double error = HeadingError(Heading, p.TrueHeading());
+        double elapsed = p.TimeSec() - startSec;
+        double travel = p.TrueRotation() - startRotation;
+        if ((result.ToHeadingSec < 0) && (fabs(error) <= Tolerance)) result.ToHeadingSec = elapsed;
+        if (fabs(error) > SettleBand) result.SettleSec = elapsed;
+        if (travel > maxTravel) maxTravel = travel;
+        if (travel < minTravel) minTravel = travel;
+    });
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    drivetrain->TurnToHeading(Heading, Velocity, TimeOut, Tolerance);
+    result.WallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+    result.DoneSec = plant.TimeSec() - startSec;
+
+    //Overshoot along the way the bot actually turned, a 180 degree target can go either way
+    double turn = fmod(Heading - WrapHeading(startRotation) + 360.0, 360.0);
+    if ((plant.TrueRotation() - startRotation) >= 0)
+        result.OvershootDeg = maxTravel - turn;
+    else
+        result.OvershootDeg = (-minTravel) - (360.0 - turn);
+    if (result.OvershootDeg < 0) result.OvershootDeg = 0;
+
+    //Let the bot coast to rest before judging where it ended up
+    plant.Advance(1.0);
+    result.FinalErrorDeg = HeadingError(Heading, plant.TrueHeading());
+    if (fabs(result.FinalErrorDeg) > SettleBand) result.SettleSec = -1;
+
+    return result;
+}
+
+struct DriveResult
+{
+    double DoneSec;         //DriveDistance returned
+    double OvershootMm;     //Largest travel past the target
+    double FinalErrorMm;    //Along track error after the bot has come to rest
+    double LateralMm;       //Cross track error after the bot has come to rest
+    double HeadingDeg;      //Heading change after the bot has come to rest
+    double WallUs;          //Host time spent simulating the drive
+};
+
+static DriveResult RunDrive(const TurnGains &Gains, double Distance, double Velocity, double Mismatch, double TimeOut)
+{
+    SimPlantParams params;
+    params.LeftMotorScale = 1.0 + (Mismatch / 2.0);
+    params.RightMotorScale = 1.0 - (Mismatch / 2.0);
+    params.BatteryVolts = gBatteryVolts;
+    SimPlant plant(params);
+    std::unique_ptr<Min6AutoDrivetrain> drivetrain = MakeDrivetrain(plant);
+    drivetrain->Set_DRIVE_PID(Gains.Kp, Gains.Ki, Gains.Kd);
+    drivetrain->Set_DRIVE_FEEDFORWARD(Gains.Ks, Gains.Kv, Gains.Ka);
+
+    DriveResult result;
+    result.OvershootMm = 0;
+    double direction = (Distance < 0) ? -1.0 : 1.0;
+    double startSec = plant.TimeSec();
+    plant.SetStepObserver([&](const SimPlant &p)
+    {
+        double past = direction * (p.TrueY() - Distance);
+        if (past > result.OvershootMm) result.OvershootMm = past;
+    });
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    drivetrain->DriveDistance(Distance, Velocity, TimeOut);
+    result.WallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+    result.DoneSec = plant.TimeSec() - startSec;
+
+    plant.Advance(1.0);
+    result.FinalErrorMm = Distance - plant.TrueY();
+    result.LateralMm = plant.TrueX();
+    result.HeadingDeg = HeadingError(plant.TrueHeading(), 0.0);
+
+    return result;
+}
+
+static int RunDriveGrid(const TurnGains &Gains, double Mismatch, double TimeOut, bool Csv)
+{
+    if (Csv)
+        printf("Distance, DriveVelocity, Done, Overshoot, FinalError, Lateral, Heading, WallUs\n");
+    else
+    {
+        printf("Drive benchmark: gains %.3f/%.3f/%.3f, feedforward %.3f/%.5f/%.6f, motor mismatch %.3f, timeout %.1f s\n",
+            Gains.Kp, Gains.Ki, Gains.Kd, Gains.Ks, Gains.Kv, Gains.Ka, Mismatch, TimeOut);
+        printf("%8s %6s %9s %10s %9s %9s %9s %9s\n", "Dist", "Vel", "Done(s)", "Overshoot", "FinalErr", "Lateral", "Heading", "Wall(us)");
+    }
+
+    int runs = 0;
+    double totalDone = 0;
+    double worstError = 0;
+    double worstHeading = 0;
+    for (size_t v = 0; v < sizeof(gVelocities) / sizeof(gVelocities[0]); v++)
+    {
+        for (size_t d = 0; d < sizeof(gDistances) / sizeof(gDistances[0]); d++)
+        {
+            DriveResult r = RunDrive(Gains, gDistances[d], gVelocities[v], Mismatch, TimeOut);
+            if (Csv)
+                printf("%f, %f, %f, %f, %f, %f, %f, %f\n", gDistances[d], gVelocities[v], r.DoneSec, r.OvershootMm, r.FinalErrorMm, r.LateralMm, r.HeadingDeg, r.WallUs);
+            else
+                printf("%8.1f %6.1f %9.3f %10.2f %9.2f %9.2f %9.2f %9.0f\n", gDistances[d], gVelocities[v], r.DoneSec, r.OvershootMm, r.FinalErrorMm, r.LateralMm, r.HeadingDeg, r.WallUs);
+            runs++;
+            totalDone += r.DoneSec;
+            if (fabs(r.FinalErrorMm) > worstError) worstError = fabs(r.FinalErrorMm);
+            if (fabs(r.HeadingDeg) > worstHeading) worstHeading = fabs(r.HeadingDeg);
+        }
+    }
+
+    if (!Csv)
+        printf("\n%d drives, mean done %.3f s, worst final error %.2f mm, worst heading change %.2f deg\n", runs, totalDone / runs, worstError, worstHeading);
+
+    return 0;
+}
+
+struct SensorResult
+{
+    bool Fired;             //DriveUntil returned true
+    double DoneSec;         //DriveUntil returned
+    double StopErrorMm;     //After the bot has come to rest: standoff runs, closer than the standoff; line runs, sensor past the line centre
+    double WallUs;          //Host time spent simulating the drive
+};
+
+/// @brief DriveUntil toward a wall (Standoff) or a tape line (Line) Place mm ahead of the sensor's start position
+static SensorResult RunSensor(const TurnGains &Gains, DriveTrigger::Kinds Kind, double Place, double Velocity, double Mismatch, double TimeOut)
+{
+    SimPlantParams params;
+    params.LeftMotorScale = 1.0 + (Mismatch / 2.0);
+    params.RightMotorScale = 1.0 - (Mismatch / 2.0);
+    params.BatteryVolts = gBatteryVolts;
+    params.WallY = params.SensorOffsetMm + ((Kind == DriveTrigger::Standoff) ? Place : 5000.0);
+    params.LineY = params.SensorOffsetMm + ((Kind == DriveTrigger::Line) ? Place : 5000.0);
+    SimPlant plant(params);
+    std::unique_ptr<Min6AutoDrivetrain> drivetrain = MakeDrivetrain(plant);
+    drivetrain->Set_DRIVE_PID(Gains.Kp, Gains.Ki, Gains.Kd);
+    drivetrain->Set_DRIVE_FEEDFORWARD(Gains.Ks, Gains.Kv, Gains.Ka);
+    drivetrain->Set_FRONT_DISTANCE_SENSOR(plant.Distance);
+    drivetrain->Set_FRONT_OPTICAL_SENSOR(plant.Optical);
+
+    DriveTrigger trigger = (Kind == DriveTrigger::Standoff) ? StandoffTrigger(gStandoffMm) : LineTrigger(50.0);
+    SensorResult result;
+    double startSec = plant.TimeSec();
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    result.Fired = drivetrain->DriveUntil(trigger, Place + 500.0, Velocity, TimeOut);
+    result.WallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+    result.DoneSec = plant.TimeSec() - startSec;
+
+    plant.Advance(1.0);
+    if (Kind == DriveTrigger::Standoff)
+        result.StopErrorMm = gStandoffMm - (params.WallY - plant.TrueSensorY());
+    else
+        result.StopErrorMm = plant.TrueSensorY() - params.LineY;
+
+    return result;
+}
+
+static int RunSensorGrid(const TurnGains &Gains, double Mismatch, double TimeOut, bool Csv)
+{
+    if (Csv)
+        printf("Trigger, Place, DriveVelocity, Fired, Done, StopError, WallUs\n");
+    else
+    {
+        printf("Sensor benchmark: standoff %.0f mm, line brightness 50%%, gains %.3f/%.3f/%.3f, feedforward %.3f/%.5f/%.6f, motor mismatch %.3f, timeout %.1f s\n",
+            gStandoffMm, Gains.Kp, Gains.Ki, Gains.Kd, Gains.Ks, Gains.Kv, Gains.Ka, Mismatch, TimeOut);
+        printf("%9s %8s %6s %6s %9s %9s %9s\n", "Trigger", "Place", "Vel", "Fired", "Done(s)", "StopErr", "Wall(us)");
+    }
+
+    int runs = 0;
+    int missed = 0;
+    double worstStandoff = 0;
+    double worstLine = 0;
+    for (int k = 0; k < 2; k++)
+    {
+        DriveTrigger::Kinds kind = (k == 0) ? DriveTrigger::Standoff : DriveTrigger::Line;
+        const double *places = (k == 0) ? gWallDistances : gLineDistances;
+        size_t placeCount = (k == 0) ? sizeof(gWallDistances) / sizeof(gWallDistances[0]) : sizeof(gLineDistances) / sizeof(gLineDistances[0]);
+        for (size_t v = 0; v < sizeof(gVelocities) / sizeof(gVelocities[0]); v++)
+        {
+            for (size_t p = 0; p < placeCount; p++)
+            {
+                SensorResult r = RunSensor(Gains, kind, places[p], gVelocities[v], Mismatch, TimeOut);
+                const char *name = (k == 0) ? "Standoff" : "Line";
+                if (Csv)
+                    printf("%s, %f, %f, %d, %f, %f, %f\n", name, places[p], gVelocities[v], r.Fired ? 1 : 0, r.DoneSec, r.StopErrorMm, r.WallUs);
+                else
+                    printf("%9s %8.1f %6.1f %6s %9.3f %9.2f %9.0f\n", name, places[p], gVelocities[v], r.Fired ? "yes" : "no", r.DoneSec, r.StopErrorMm, r.WallUs);
+                runs++;
+                if (!r.Fired) missed++;
+                double &worst = (k == 0) ? worstStandoff : worstLine;
+                if (fabs(r.StopErrorMm) > worst) worst = fabs(r.StopErrorMm);
+            }
+        }
+    }
+
+    if (!Csv)
+        printf("\n%d drives, %d triggers missed, worst standoff error %.2f mm, worst stop past line %.2f mm\n", runs, missed, worstStandoff, worstLine);
+
+    return 0;
+}
+
+struct PathResult
+{
+    double DoneSec;         //Routine returned
+    double PositionMm;      //Distance from the corner target after the bot has come to rest
+    double HeadingDeg;      //Heading error after the bot has come to rest
+    double WallUs;          //Host time spent simulating the route
+};
+
+/// @brief Get to (600, 600) facing 90 degrees from the origin facing 0. Route 0 drives, pivots and drives, route 1
+/// chains a drive, an arc and a drive without stopping, route 2 follows the two waypoints with pure pursuit.
+static PathResult RunPath(const TurnGains &TurnGain, const TurnGains &DriveGain, int Route, double Velocity, double Mismatch, double TimeOut)
+{
+    SimPlantParams params;
+    params.LeftMotorScale = 1.0 + (Mismatch / 2.0);
+    params.RightMotorScale = 1.0 - (Mismatch / 2.0);
+    params.BatteryVolts = gBatteryVolts;
+    SimPlant plant(params);
+    std::unique_ptr<Min6AutoDrivetrain> drivetrain = MakeDrivetrain(plant);
+    drivetrain->Set_TURN_PID(TurnGain.Kp, TurnGain.Ki, TurnGain.Kd);
+    drivetrain->Set_TURN_FEEDFORWARD(TurnGain.Ks, TurnGain.Kv, TurnGain.Ka);
+    drivetrain->Set_DRIVE_PID(DriveGain.Kp, DriveGain.Ki, DriveGain.Kd);
+    drivetrain->Set_DRIVE_FEEDFORWARD(DriveGain.Ks, DriveGain.Kv, DriveGain.Ka);
+
+    RoutineStep steps[3];
+    int count = 0;
+    if (Route == 0)
+    {
+        steps[count++] = DriveStep(600.0, Velocity, TimeOut);
+        steps[count++] = TurnStep(90.0, Velocity, TimeOut, 1.0);
+        steps[count++] = DriveStep(600.0, Velocity, TimeOut);
+    }
+    else if (Route == 1)
+    {
+        steps[count++] = DriveStep(600.0 - gArcRadius, Velocity, TimeOut);
+        steps[count++] = ArcStep(gArcRadius, 90.0, Velocity, TimeOut);
+        steps[count++] = DriveStep(600.0 - gArcRadius, Velocity, TimeOut);
+    }
+    else
+        steps[count++] = PathStep(gCornerPath, 2, Velocity, gLookahead, TimeOut);
+    RoutineTable routine = { "Corner", steps, count };
+
+    PathResult result;
+    double startSec = plant.TimeSec();
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    drivetrain->RunRoutine(routine);
+    result.WallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+    result.DoneSec = plant.TimeSec() - startSec;
+
+    plant.Advance(1.0);
+    result.PositionMm = hypot(plant.TrueX() - 600.0, plant.TrueY() - 600.0);
+    result.HeadingDeg = HeadingError(90.0, plant.TrueHeading());
+
+    return result;
+}
+
+static int RunPathGrid(const TurnGains &TurnGain, const TurnGains &DriveGain, double Mismatch, double TimeOut, bool Csv)
+{
+    static const char *routes[] = { "Pivot", "Arc", "Pursuit" };
+    if (Csv)
+        printf("Route, DriveVelocity, Done, PositionError, HeadingError, WallUs\n");
+    else
+    {
+        printf("Path benchmark: origin to (600, 600) facing 90 deg, arc radius %.0f mm, lookahead %.0f mm, motor mismatch %.3f, timeout %.1f s\n",
+            gArcRadius, gLookahead, Mismatch, TimeOut);
+        printf("%8s %6s %9s %9s %9s %9s\n", "Route", "Vel", "Done(s)", "PosErr", "HdgErr", "Wall(us)");
+    }
+
+    double totalDone[3] = { 0, 0, 0 };
+    double worstPosition[3] = { 0, 0, 0 };
+    int runs = 0;
+    for (int route = 0; route < 3; route++)
+    {
+        for (size_t v = 1; v < sizeof(gVelocities) / sizeof(gVelocities[0]); v++)
+        {
+            PathResult r = RunPath(TurnGain, DriveGain, route, gVelocities[v], Mismatch, TimeOut);
+            if (Csv)
+                printf("%s, %f, %f, %f, %f, %f\n", routes[route], gVelocities[v], r.DoneSec, r.PositionMm, r.HeadingDeg, r.WallUs);
+            else
+                printf("%8s %6.1f %9.3f %9.2f %9.2f %9.0f\n", routes[route], gVelocities[v], r.DoneSec, r.PositionMm, r.HeadingDeg, r.WallUs);
+            totalDone[route] += r.DoneSec;
+            if (r.PositionMm > worstPosition[route]) worstPosition[route] = r.PositionMm;
+            if (route == 0) runs++;
+        }
+    }
+
+    if (!Csv)
+    {
+        printf("\n");
+        for (int route = 0; route < 3; route++)
+            printf("%s: mean done %.3f s, worst position error %.2f mm\n", routes[route], totalDone[route] / runs, worstPosition[route]);
+    }
+
+    return 0;
+}
+
+/// @brief Drive motor that forwards to a simulated motor. Once armed it cancels all motion from inside the motion
+/// task, on its first Position read (right after a motion is dequeued) or its first Stop (between routine steps),
+/// and counts the drive commands that follow the cancel.
+class CancelProbeMotor : public IDriveMotor
+{
+    public:
+        enum Hooks
+        {
+            Off,
+            FirstRead,
+            FirstStop
+        };
+
+    private:
+        SimDriveMotor &m_Motor;
+        Min6AutoDrivetrain *m_Drivetrain;
+        std::atomic<int> _hook;
+        std::atomic<bool> _cancelled;
+        std::atomic<int> _spinsAfterCancel;
+
+        void Fire(Hooks Hook)
+        {
+            if (_hook != Hook) return;
+            _hook = Off;
+            _cancelled = true;
+            m_Drivetrain->CancelAllMotion();
+        }
+
+    public:
+        CancelProbeMotor(SimDriveMotor &Motor) : m_Motor(Motor), m_Drivetrain(0), _hook(Off), _cancelled(false), _spinsAfterCancel(0) {}
+
+        void Arm(Min6AutoDrivetrain &Drivetrain, Hooks Hook)
+        {
+            m_Drivetrain = &Drivetrain;
+            _cancelled = false;
+            _spinsAfterCancel = 0;
+            _hook = Hook;
+        }
+
+        bool Cancelled() const { return _cancelled; }
+        int SpinsAfterCancel() const { return _spinsAfterCancel; }
+
+        void Spin(double VelocityRPM)
+        {
+            if (_cancelled && (VelocityRPM != 0)) _spinsAfterCancel++;
+            m_Motor.Spin(VelocityRPM);
+        }
+
+        void Stop()
+        {
+            Fire(FirstStop);
+            m_Motor.Stop();
+        }
+
+        double Velocity() { return m_Motor.Velocity(); }
+
+        double Position()
+        {
+            Fire(FirstRead);
+            return m_Motor.Position();
+        }
+
+        void ResetPosition() { m_Motor.ResetPosition(); }
+};
+
+/// @brief Queue each kind of async motion, cancel it from inside the motion task right after it is dequeued (or
+/// between routine steps) and check that no drive command follows: the motion stops within the tick of the cancel.
+/// @return [int] 0 if every motion stopped, 1 otherwise
+static int RunCancelChecks()
+{
+    static const PathPoint path[] = { { 0.0, 600.0 }, { 600.0, 600.0 } };
+    static RoutineStep turnRoutine[] = { TurnStep(90.0, 50.0, 5.0, 1.0), DriveStep(300.0, 50.0, 5.0) };
+    static RoutineStep pathRoutine[] = { PathStep(path, 2, 75.0, gLookahead, 5.0) };
+    static const RoutineTable routines[] = { { "Turn and drive", turnRoutine, 2 }, { "Path", pathRoutine, 1 } };
+
+    //The motion task runs for the life of the program, so the plant and drivetrain it uses are never freed
+    SimPlant *plant = new SimPlant();
+    CancelProbeMotor *left = new CancelProbeMotor(plant->LeftMotor);
+    Min6AutoDrivetrain *drivetrain = new Min6AutoDrivetrain(plant->Brain, plant->Inertial, plant->RightMotor, *left, gMinSixConfig);
+    drivetrain->Set_LogLevel(gLogLevel);
+    drivetrain->Set_TURN_PID(1.0, 0.0, 0.1);
+    drivetrain->Set_TURN_FEEDFORWARD(5.0, 0.0, 0.016);
+    drivetrain->Set_DRIVE_PID(0.1, 0.0, 0.01);
+    drivetrain->Set_DRIVE_FEEDFORWARD(5.0, 0.0, 0.011);
+
+    printf("Cancel check: each motion is cancelled from inside the motion task, no drive command may follow\n");
+    printf("%-26s %10s %10s %9s\n", "Motion", "Cancelled", "Commands", "Stopped");
+    int failed = 0;
+    //The path routine is cancelled on its first Stop: the path step stops the motors before it starts, after the
+    //routine has checked for a cancel
+    static const char *names[] = { "TurnToHeadingAsync", "DriveDistanceAsync", "ArcTurnAsync", "FollowPathAsync",
+                                   "RunRoutineAsync", "Between routine steps" };
+    for (int m = 0; m < 6; m++)
+    {
+        drivetrain->ResetPose();
+        left->Arm(*drivetrain, (m < 5) ? CancelProbeMotor::FirstRead : CancelProbeMotor::FirstStop);
+        MotionHandle handle;
+        if (m == 0) handle = drivetrain->TurnToHeadingAsync(WrapHeading(plant->TrueHeading() + 90.0), 50.0, 5.0, 1.0);
+        else if (m == 1) handle = drivetrain->DriveDistanceAsync(300.0, 50.0, 5.0);
+        else if (m == 2) handle = drivetrain->ArcTurnAsync(200.0, 90.0, 50.0, 5.0);
+        else if (m == 3) handle = drivetrain->FollowPathAsync(path, 2, 75.0, gLookahead, 5.0);
+        else handle = drivetrain->RunRoutineAsync(routines[(m == 4) ? 0 : 1]);
+        handle.wait();
+        plant->Advance(0.5);
+
+        bool stopped = left->Cancelled() && (left->SpinsAfterCancel() == 0);
+        if (!stopped) failed++;
+        printf("%-26s %10s %10d %9s\n", names[m], left->Cancelled() ? "yes" : "no", left->SpinsAfterCancel(), stopped ? "ok" : "FAIL");
+    }
+    printf("\n%s\n", (failed == 0) ? "All cancelled motions stopped" : "Cancelled motions kept driving");
+    return (failed == 0) ? 0 : 1;
+}
+
+static void PrintUsage()
+{
+    printf("usage: turn_bench [-start deg] [-kp k] [-ki k] [-kd k] [-ks k] [-kv k] [-ka k] [-tol deg] [-band deg] [-timeout sec] [-battery volts] [-nocomp] [-csv] [-log]\n");
+    printf("       turn_bench -drive [-kp k] [-ki k] [-kd k] [-ks k] [-kv k] [-ka k] [-mismatch fraction] [-timeout sec] [-battery volts] [-nocomp] [-csv] [-log]\n");
+    printf("       turn_bench -sensor [-kp k] [-ki k] [-kd k] [-ks k] [-kv k] [-ka k] [-mismatch fraction] [-timeout sec] [-battery volts] [-nocomp] [-csv] [-log]\n");
+    printf("       turn_bench -path [-mismatch fraction] [-timeout sec] [-battery volts] [-nocomp] [-csv] [-log]\n");
+    printf("       turn_bench -cancel [-log]\n");
+}
+
+int main(int argc, char **argv)
+{
+    double startHeading = 0.0;
+    TurnGains gains = { 1.0, 0.0, 0.1, 5.0, 0.0, -1.0 };
+    double tolerance = 1.0;
+    double settleBand = 1.0;
+    double timeOut = -1.0;
+    bool csv = false;
+    bool drive = false;
+    bool sensor = false;
+    bool path = false;
+    bool cancel = false;
+    bool gainsSet = false;
+    double mismatch = 0.04;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-start") == 0) && (i + 1 < argc)) startHeading = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-kp") == 0) && (i + 1 < argc)) { gains.Kp = atof(argv[++i]); gainsSet = true; }
+        else if ((strcmp(argv[i], "-ki") == 0) && (i + 1 < argc)) { gains.Ki = atof(argv[++i]); gainsSet = true; }
+        else if ((strcmp(argv[i], "-kd") == 0) && (i + 1 < argc)) { gains.Kd = atof(argv[++i]); gainsSet = true; }
+        else if ((strcmp(argv[i], "-ks") == 0) && (i + 1 < argc)) gains.Ks = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-kv") == 0) && (i + 1 < argc)) gains.Kv = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-ka") == 0) && (i + 1 < argc)) gains.Ka = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-mismatch") == 0) && (i + 1 < argc)) mismatch = atof(argv[++i]);
+        else if (strcmp(argv[i], "-drive") == 0) drive = true;
+        else if (strcmp(argv[i], "-sensor") == 0) sensor = true;
+        else if (strcmp(argv[i], "-path") == 0) path = true;
+        else if (strcmp(argv[i], "-cancel") == 0) cancel = true;
+        else if ((strcmp(argv[i], "-tol") == 0) && (i + 1 < argc)) tolerance = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-band") == 0) && (i + 1 < argc)) settleBand = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-timeout") == 0) && (i + 1 < argc)) timeOut = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-battery") == 0) && (i + 1 < argc)) gBatteryVolts = atof(argv[++i]);
+        else if (strcmp(argv[i], "-nocomp") == 0) gBatteryCompensation = false;
+        else if (strcmp(argv[i], "-csv") == 0) csv = true;
+        else if (strcmp(argv[i], "-log") == 0) gLogLevel = Min6AutoDrivetrain::LogLevels::Verbose;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    //Default kA: the simulated 80ms motor lag on top of the geometric kV
+    if (gains.Ka < 0) gains.Ka = (drive || sensor) ? 0.011 : 0.016;
+    //Default time out: long enough for the slowest sensor drives to reach their trigger
+    if (timeOut < 0) timeOut = sensor ? 10.0 : 5.0;
+
+    if (cancel) return RunCancelChecks();
+
+    if (path)
+    {
+        //The tuned turn and drive defaults, the route mixes both
+        TurnGains turnGains = { 1.0, 0.0, 0.1, 5.0, 0.0, 0.016 };
+        TurnGains driveGains = { 0.1, 0.0, 0.01, 5.0, 0.0, 0.011 };
+        return RunPathGrid(turnGains, driveGains, mismatch, timeOut, csv);
+    }
+
+    if (drive || sensor)
+    {
+        if (!gainsSet)
+        {
+            gains.Kp = 0.1;
+            gains.Ki = 0.0;
+            gains.Kd = 0.01;
+        }
+        return sensor ? RunSensorGrid(gains, mismatch, timeOut, csv) : RunDriveGrid(gains, mismatch, timeOut, csv);
+    }
+
+    if (csv)
+        printf("Heading, TurnVelocity, Done, ToHeading, Settle, Overshoot, FinalError, WallUs\n");
+    else
+    {
+        printf("Turn benchmark: start %.1f deg, gains %.3f/%.3f/%.3f, feedforward %.3f/%.5f/%.6f, tolerance %.2f deg, settle band %.2f deg, timeout %.1f s\n",
+            startHeading, gains.Kp, gains.Ki, gains.Kd, gains.Ks, gains.Kv, gains.Ka, tolerance, settleBand, timeOut);
+        printf("%8s %6s %9s %9s %9s %10s %9s %9s\n", "Heading", "Vel", "Done(s)", "ToHdg(s)", "Settle(s)", "Overshoot", "FinalErr", "Wall(us)");
+    }
+
+    int runs = 0;
+    int unsettled = 0;
+    double totalDone = 0;
+    double totalWall = 0;
+    double worstOvershoot = 0;
+    for (size_t v = 0; v < sizeof(gVelocities) / sizeof(gVelocities[0]); v++)
+    {
+        for (size_t h = 0; h < sizeof(gHeadings) / sizeof(gHeadings[0]); h++)
+        {
+            TurnResult r = RunTurn(gains, startHeading, gHeadings[h], gVelocities[v], tolerance, settleBand, timeOut);
+            if (csv)
+                printf("%f, %f, %f, %f, %f, %f, %f, %f\n", gHeadings[h], gVelocities[v], r.DoneSec, r.ToHeadingSec, r.SettleSec, r.OvershootDeg, r.FinalErrorDeg, r.WallUs);
+            else
+                printf("%8.1f %6.1f %9.3f %9.3f %9.3f %10.2f %9.2f %9.0f\n", gHeadings[h], gVelocities[v], r.DoneSec, r.ToHeadingSec, r.SettleSec, r.OvershootDeg, r.FinalErrorDeg, r.WallUs);
+            runs++;
+            totalDone += r.DoneSec;
+            totalWall += r.WallUs;
+            if (r.SettleSec < 0) unsettled++;
+            if (r.OvershootDeg > worstOvershoot) worstOvershoot = r.OvershootDeg;
+        }
+    }
+
+    if (!csv)
+    {
+        printf("\n%d turns, mean done %.3f s, worst overshoot %.2f deg, %d unsettled, mean wall %.0f us/turn\n",
+            runs, totalDone / runs, worstOvershoot, unsettled, totalWall / runs);
+    }
+
+    return 0;
+}
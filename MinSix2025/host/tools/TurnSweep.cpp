@@ -0,0 +1,366 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       TurnSweep.cpp                                             */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      10/17/2026                                                */
+/*    Description:  Sweeps the TurnToHeading parameters and turn gains over   */
+/*                  the simulated drivetrain on every core, with Monte Carlo  */
+/*                  gyro and motor noise, and prints the Pareto front of      */
+/*                  completion time against final heading error               */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "SimHardware.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+
+//Turns every configuration runs from a random start heading in each trial: [deg] clockwise
+static const double gTurns[] = { 45.0, 90.0, 180.0, -90.0 };
+
+/// @brief One point of the sweep: the TurnToHeading arguments and the turn gains
+struct SweepConfig
+{
+    double TurnVelocity;
+    int AccertionSteps;
+    double HeadingTolerance;
+    double TimeOut;
+    double Kp, Ki, Kd;
+};
+
+/// @brief Results of one configuration over every trial and turn
+struct SweepResult
+{
+    double MeanDoneSec;     //TurnToHeading returned
+    double WorstDoneSec;
+    double MeanErrorDeg;    //Absolute error after the bot has come to rest
+    double WorstErrorDeg;
+    int TimedOut;           //Turns that ran into TimeOut
+};
+
+/// @brief Plant variation of one Monte Carlo trial, shared by every configuration so they all meet the same bots
+struct SweepTrial
+{
+    SimPlantParams Params;
+    double StartHeading;
+};
+
+/// @brief Sweep axes, the grid is every combination
+struct SweepGrid
+{
+    std::vector<double> Velocities;
+    std::vector<double> Steps;
+    std::vector<double> Tolerances;
+    std::vector<double> TimeOuts;
+    std::vector<double> Kp;
+    std::vector<double> Ki;
+    std::vector<double> Kd;
+
+    size_t Size() const
+    {
+        return Velocities.size() * Steps.size() * Tolerances.size() * TimeOuts.size() * Kp.size() * Ki.size() * Kd.size();
+    }
+
+    /// @brief Configuration at a flat index, the gains vary fastest
+    SweepConfig At(size_t Index) const
+    {
+        SweepConfig config;
+        config.Kd = Kd[Index % Kd.size()];                          Index /= Kd.size();
+        config.Ki = Ki[Index % Ki.size()];                          Index /= Ki.size();
+        config.Kp = Kp[Index % Kp.size()];                          Index /= Kp.size();
+        config.TimeOut = TimeOuts[Index % TimeOuts.size()];         Index /= TimeOuts.size();
+        config.HeadingTolerance = Tolerances[Index % Tolerances.size()]; Index /= Tolerances.size();
+        config.AccertionSteps = (int)Steps[Index % Steps.size()];   Index /= Steps.size();
+        config.TurnVelocity = Velocities[Index % Velocities.size()];
+        return config;
+    }
+};
+
+struct TurnFeedforward
+{
+    double Ks, Kv, Ka;
+};
+
+/// @brief Signed shortest angle from Heading to Target
+static double HeadingError(double Target, double Heading)
+{
+    double error = fmod(Target - Heading, 360.0);
+    if (error > 180.0) error -= 360.0;
+    if (error <= -180.0) error += 360.0;
+    return error;
+}
+
+static double WrapHeading(double Heading)
+{
+    Heading = fmod(Heading, 360.0);
+    if (Heading < 0) Heading += 360.0;
+    return Heading;
+}
+
+/// @brief Draw the plant of every trial. Noise 0 gives the nominal bot in every trial, 1 the spread seen between
+/// our bots and packs, larger values stress the settings further.
+static std::vector<SweepTrial> MakeTrials(int Count, double Noise, unsigned int Seed)
+{
+    std::mt19937 random(Seed);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> heading(0.0, 360.0);
+    std::vector<SweepTrial> trials(Count);
+    for (int t = 0; t < Count; t++)
+    {
+        SimPlantParams &params = trials[t].Params;
+        double mismatch = 0.04 * Noise * unit(random);
+        params.LeftMotorScale = 1.0 + (mismatch / 2.0);
+        params.RightMotorScale = 1.0 - (mismatch / 2.0);
+        params.MotorTimeConstantSec *= 1.0 + (0.25 * Noise * unit(random));
+        params.StallRPM *= 1.0 + (0.5 * Noise * unit(random));
+        params.BatteryVolts = 7.7 + (0.5 * Noise * unit(random));
+        params.GyroNoiseDeg *= 1.0 + (Noise * unit(random));
+        params.GyroDriftDegPerSec = 0.02 * Noise * unit(random);
+        if (params.MotorTimeConstantSec < params.PhysicsStepSec) params.MotorTimeConstantSec = params.PhysicsStepSec;
+        if (params.GyroNoiseDeg < 0) params.GyroNoiseDeg = 0;
+        params.Seed = Seed + 1 + (unsigned int)t;
+        trials[t].StartHeading = heading(random);
+    }
+    return trials;
+}
+
+static SweepResult RunConfig(const SweepConfig &Config, const TurnFeedforward &Feedforward, const std::vector<SweepTrial> &Trials)
+{
+    SweepResult result;
+    result.MeanDoneSec = 0;
+    result.WorstDoneSec = 0;
+    result.MeanErrorDeg = 0;
+    result.WorstErrorDeg = 0;
+    result.TimedOut = 0;
+    int runs = 0;
+
+    for (size_t t = 0; t < Trials.size(); t++)
+    {
+        for (size_t r = 0; r < sizeof(gTurns) / sizeof(gTurns[0]); r++)
+        {
+            SimPlant plant(Trials[t].Params);
+            plant.SetTrueRotation(Trials[t].StartHeading);
+            Min6AutoDrivetrain drivetrain(plant.Brain, plant.Inertial, plant.RightMotor, plant.LeftMotor, gMinSixConfig);
+            drivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::None);
+            drivetrain.Set_TURN_PID(Config.Kp, Config.Ki, Config.Kd);
+            drivetrain.Set_TURN_FEEDFORWARD(Feedforward.Ks, Feedforward.Kv, Feedforward.Ka);
+            drivetrain.Set_BATTERY_COMPENSATION(8.0, 6.5);
+
+            double target = WrapHeading(Trials[t].StartHeading + gTurns[r]);
+            double startSec = plant.TimeSec();
+            drivetrain.TurnToHeading(target, Config.TurnVelocity, Config.TimeOut, Config.HeadingTolerance, Config.AccertionSteps);
+            double done = plant.TimeSec() - startSec;
+
+            //Let the bot coast to rest before judging where it ended up
+            plant.Advance(1.0);
+            double error = fabs(HeadingError(target, plant.TrueHeading()));
+
+            result.MeanDoneSec += done;
+            result.MeanErrorDeg += error;
+            if (done > result.WorstDoneSec) result.WorstDoneSec = done;
+            if (error > result.WorstErrorDeg) result.WorstErrorDeg = error;
+            if (done >= Config.TimeOut - 0.001) result.TimedOut++;
+            runs++;
+        }
+    }
+    if (runs > 0)
+    {
+        result.MeanDoneSec /= runs;
+        result.MeanErrorDeg /= runs;
+    }
+    return result;
+}
+
+/// @brief Run every configuration of the grid on Threads workers. Each worker takes the next configuration
+/// index until none are left; results land at their index so the output does not depend on the thread count.
+static void RunSweep(const SweepGrid &Grid, const TurnFeedforward &Feedforward, const std::vector<SweepTrial> &Trials,
+                     int Threads, std::vector<SweepResult> &Results)
+{
+    size_t count = Grid.Size();
+    Results.resize(count);
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> finished(0);
+
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            size_t index = next.fetch_add(1);
+            if (index >= count) break;
+            Results[index] = RunConfig(Grid.At(index), Feedforward, Trials);
+            size_t done = finished.fetch_add(1) + 1;
+            if ((done % ((count / 10) + 1)) == 0) fprintf(stderr, "%zu/%zu configurations\n", done, count);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < Threads; i++) pool.push_back(std::thread(worker));
+    for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+}
+
+/// @brief Indices of the configurations no other configuration beats on both mean completion time and worst
+/// final error, fastest first
+static std::vector<size_t> ParetoFront(const std::vector<SweepResult> &Results)
+{
+    std::vector<size_t> order(Results.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        if (Results[a].MeanDoneSec != Results[b].MeanDoneSec) return Results[a].MeanDoneSec < Results[b].MeanDoneSec;
+        if (Results[a].WorstErrorDeg != Results[b].WorstErrorDeg) return Results[a].WorstErrorDeg < Results[b].WorstErrorDeg;
+        return a < b;
+    });
+
+    //Walking from the fastest, a configuration is on the front if it is more accurate than every faster one
+    std::vector<size_t> front;
+    double bestError = -1;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const SweepResult &r = Results[order[i]];
+        if ((bestError < 0) || (r.WorstErrorDeg < bestError))
+        {
+            front.push_back(order[i]);
+            bestError = r.WorstErrorDeg;
+        }
+    }
+    return front;
+}
+
+/// @brief Parse a comma separated list of numbers
+static bool ParseList(const char *Text, std::vector<double> &Values)
+{
+    Values.clear();
+    const char *p = Text;
+    while (*p != 0)
+    {
+        char *end;
+        double value = strtod(p, &end);
+        if (end == p) return false;
+        Values.push_back(value);
+        p = end;
+        if (*p == ',') p++;
+        else if (*p != 0) return false;
+    }
+    return !Values.empty();
+}
+
+static void PrintUsage()
+{
+    printf("usage: turn_sweep [-vel list] [-steps list] [-tol list] [-timeout list] [-kp list] [-ki list] [-kd list]\n");
+    printf("                  [-ks k] [-kv k] [-ka k] [-trials n] [-noise scale] [-seed n] [-threads n] [-maxerr deg] [-csv]\n");
+    printf("       lists are comma separated, e.g. -vel 30,50,70\n");
+}
+
+int main(int argc, char **argv)
+{
+    SweepGrid grid;
+    double velocities[] = { 30.0, 50.0, 70.0, 90.0, 110.0 };
+    double steps[] = { 3.0, 5.0, 10.0, 15.0 };
+    double tolerances[] = { 0.1, 0.25, 0.5, 1.0 };
+    double timeOuts[] = { 1.0, 2.0, 5.0 };
+    double kp[] = { 0.5, 1.0, 1.5, 2.0 };
+    double ki[] = { 0.0, 0.5 };
+    double kd[] = { 0.0, 0.05, 0.1, 0.2 };
+    grid.Velocities.assign(velocities, velocities + sizeof(velocities) / sizeof(velocities[0]));
+    grid.Steps.assign(steps, steps + sizeof(steps) / sizeof(steps[0]));
+    grid.Tolerances.assign(tolerances, tolerances + sizeof(tolerances) / sizeof(tolerances[0]));
+    grid.TimeOuts.assign(timeOuts, timeOuts + sizeof(timeOuts) / sizeof(timeOuts[0]));
+    grid.Kp.assign(kp, kp + sizeof(kp) / sizeof(kp[0]));
+    grid.Ki.assign(ki, ki + sizeof(ki) / sizeof(ki[0]));
+    grid.Kd.assign(kd, kd + sizeof(kd) / sizeof(kd[0]));
+
+    TurnFeedforward feedforward = { 5.0, 0.0, 0.016 };
+    int trialCount = 8;
+    double noise = 1.0;
+    unsigned int seed = 1;
+    int threads = (int)std::thread::hardware_concurrency();
+    double maxError = 0.5;
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool ok = true;
+        if ((strcmp(argv[i], "-vel") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Velocities);
+        else if ((strcmp(argv[i], "-steps") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Steps);
+        else if ((strcmp(argv[i], "-tol") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Tolerances);
+        else if ((strcmp(argv[i], "-timeout") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.TimeOuts);
+        else if ((strcmp(argv[i], "-kp") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Kp);
+        else if ((strcmp(argv[i], "-ki") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Ki);
+        else if ((strcmp(argv[i], "-kd") == 0) && (i + 1 < argc)) ok = ParseList(argv[++i], grid.Kd);
+        else if ((strcmp(argv[i], "-ks") == 0) && (i + 1 < argc)) feedforward.Ks = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-kv") == 0) && (i + 1 < argc)) feedforward.Kv = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-ka") == 0) && (i + 1 < argc)) feedforward.Ka = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-trials") == 0) && (i + 1 < argc)) trialCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-noise") == 0) && (i + 1 < argc)) noise = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-seed") == 0) && (i + 1 < argc)) seed = (unsigned int)atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-threads") == 0) && (i + 1 < argc)) threads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-maxerr") == 0) && (i + 1 < argc)) maxError = atof(argv[++i]);
+        else if (strcmp(argv[i], "-csv") == 0) csv = true;
+        else ok = false;
+        if (!ok)
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (trialCount < 1) trialCount = 1;
+
+    std::vector<SweepTrial> trials = MakeTrials(trialCount, noise, seed);
+    std::vector<SweepResult> results;
+    int turns = trialCount * (int)(sizeof(gTurns) / sizeof(gTurns[0]));
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    RunSweep(grid, feedforward, trials, threads, results);
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (csv)
+    {
+        printf("TurnVelocity, AccertionSteps, HeadingTolerance, TimeOut, Kp, Ki, Kd, MeanDone, WorstDone, MeanError, WorstError, TimedOut\n");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            SweepConfig c = grid.At(i);
+            const SweepResult &r = results[i];
+            printf("%f, %d, %f, %f, %f, %f, %f, %f, %f, %f, %f, %d\n", c.TurnVelocity, c.AccertionSteps, c.HeadingTolerance, c.TimeOut,
+                c.Kp, c.Ki, c.Kd, r.MeanDoneSec, r.WorstDoneSec, r.MeanErrorDeg, r.WorstErrorDeg, r.TimedOut);
+        }
+        return 0;
+    }
+
+    printf("Turn sweep: %zu configurations x %d turns (%d trials, noise %.2f, seed %u), feedforward %.3f/%.5f/%.6f\n",
+        results.size(), turns, trialCount, noise, seed, feedforward.Ks, feedforward.Kv, feedforward.Ka);
+    printf("%zu turns on %d threads in %.1f s, %.0f turns/s\n\n",
+        results.size() * turns, threads, wallSec, (results.size() * turns) / wallSec);
+
+    std::vector<size_t> front = ParetoFront(results);
+    printf("Pareto front, mean completion time against worst final error:\n");
+    printf("%6s %5s %6s %7s %6s %6s %6s %9s %9s %9s %9s %8s\n",
+        "Vel", "Steps", "Tol", "TimeOut", "Kp", "Ki", "Kd", "Mean(s)", "Worst(s)", "MeanErr", "WorstErr", "TimedOut");
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        SweepConfig c = grid.At(front[i]);
+        const SweepResult &r = results[front[i]];
+        printf("%6.1f %5d %6.2f %7.1f %6.3f %6.3f %6.3f %9.3f %9.3f %9.3f %9.3f %5d/%-3d\n", c.TurnVelocity, c.AccertionSteps,
+            c.HeadingTolerance, c.TimeOut, c.Kp, c.Ki, c.Kd, r.MeanDoneSec, r.WorstDoneSec, r.MeanErrorDeg, r.WorstErrorDeg, r.TimedOut, turns);
+    }
+
+    //Fastest setting that holds the error limit, written as the routine table and Set_ calls take it
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        if (results[front[i]].WorstErrorDeg > maxError) continue;
+        SweepConfig c = grid.At(front[i]);
+        printf("\nFastest within %.2f deg: Set_TURN_PID(%.3ff, %.3ff, %.3ff); TurnStep(heading, %.1ff, %.1ff, %.2ff, %d)\n",
+            maxError, c.Kp, c.Ki, c.Kd, c.TurnVelocity, c.TimeOut, c.HeadingTolerance, c.AccertionSteps);
+        return 0;
+    }
+    printf("\nNo configuration within %.2f deg\n", maxError);
+    return 0;
+}
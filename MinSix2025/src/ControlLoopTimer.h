@@ -0,0 +1,127 @@
+#include "DrivetrainHardware.h"
+#include "ControlScalar.h"
+
+#ifndef Control_Loop_Timer
+#define Control_Loop_Timer
+class ControlLoopTimer
+{
+    private:
+    IBrainHardware &m_Brain;
+    uint32_t _periodUs;
+    uint64_t _startUs;
+    uint64_t _nextDeadlineUs;
+    uint64_t _lastWakeUs;
+    uint32_t _lastDtUs;
+    uint32_t _tickCount;
+    uint32_t _overrunCount;
+    uint32_t _maxJitterUs;
+    uint64_t _totalJitterUs;
+
+    static constexpr ControlScalar SecPerUs = ControlScalar(0.000001);  //Multiplied in, no divide on every tick
+
+    public:
+    /// @brief Fixed rate loop pacing. Each tick sleeps until an absolute deadline so the
+    /// period does not stretch by the time the loop body takes.
+    /// @param Brain [IBrainHardware] time source
+    /// @param PeriodUs [us] loop period
+    ControlLoopTimer(IBrainHardware &Brain, uint32_t PeriodUs) :
+    m_Brain(Brain),
+    _periodUs(PeriodUs),
+    _startUs(0),
+    _nextDeadlineUs(0),
+    _lastWakeUs(0),
+    _lastDtUs(PeriodUs),
+    _tickCount(0),
+    _overrunCount(0),
+    _maxJitterUs(0),
+    _totalJitterUs(0)
+    {}
+
+    /// @brief Anchor the first deadline one period from now and clear the statistics
+    void Start()
+    {
+        _startUs = m_Brain.SystemTimeUs();
+        _nextDeadlineUs = _startUs + _periodUs;
+        _lastWakeUs = _startUs;
+        _lastDtUs = _periodUs;
+        _tickCount = 0;
+        _overrunCount = 0;
+        _maxJitterUs = 0;
+        _totalJitterUs = 0;
+    }
+
+    /// @brief Sleep until the next deadline. A loop body that ran past its deadline counts as
+    /// an overrun and the missed periods are skipped so the loop keeps its phase.
+    /// @return [bool] false if the deadline had already passed
+    bool WaitForNextTick()
+    {
+        bool onTime = true;
+        uint64_t now = m_Brain.SystemTimeUs();
+        if (now > _nextDeadlineUs)
+        {
+            _overrunCount++;
+            onTime = false;
+            _nextDeadlineUs += ((now - _nextDeadlineUs) / _periodUs + 1) * _periodUs;
+        }
+        m_Brain.SleepUntilUs(_nextDeadlineUs);
+
+        //Jitter is how late we woke relative to the deadline we slept for
+        now = m_Brain.SystemTimeUs();
+        uint32_t jitter = (now > _nextDeadlineUs) ? (uint32_t)(now - _nextDeadlineUs) : 0;
+        if (jitter > _maxJitterUs) _maxJitterUs = jitter;
+        _totalJitterUs += jitter;
+        _tickCount++;
+        _nextDeadlineUs += _periodUs;
+        _lastDtUs = (uint32_t)(now - _lastWakeUs);
+        _lastWakeUs = now;
+
+        return onTime;
+    }
+
+    /// @return [sec] loop period, the dt seen by the controllers
+    ControlScalar PeriodSec()
+    {
+        return (ControlScalar)_periodUs * SecPerUs;
+    }
+
+    /// @return [sec] measured time between the last two wake ups, the period before the first tick
+    ControlScalar GET_LastDtSec()
+    {
+        return (ControlScalar)_lastDtUs * SecPerUs;
+    }
+
+    /// @return [us] measured time between the last two wake ups, for exact sums of tick times
+    uint32_t GET_LastDtUs()
+    {
+        return _lastDtUs;
+    }
+
+    /// @return [sec] time since Start
+    ControlScalar ElapsedSec()
+    {
+        return (ControlScalar)(m_Brain.SystemTimeUs() - _startUs) * SecPerUs;
+    }
+
+    int GET_TickCount()
+    {
+        return _tickCount;
+    }
+
+    int GET_OverrunCount()
+    {
+        return _overrunCount;
+    }
+
+    /// @return [us] largest wake up delay past a deadline
+    uint32_t GET_MaxJitterUs()
+    {
+        return _maxJitterUs;
+    }
+
+    /// @return [us] mean wake up delay past a deadline
+    uint32_t GET_MeanJitterUs()
+    {
+        return (_tickCount > 0) ? (uint32_t)(_totalJitterUs / _tickCount) : 0;
+    }
+};
+#endif
@@ -0,0 +1,34 @@
+#include <math.h>
+
+#ifndef Control_Scalar
+#define Control_Scalar
+
+/// @brief Scalar type of the per tick control math. The IQ2 FPU is single precision and runs double math in
+/// software, so the brain build uses float. The host builds use double unless built with -DCONTROL_SCALAR_FLOAT
+/// (make SCALAR=float) to run the simulator on the brain's arithmetic.
+#if defined(VexIQ2) || defined(CONTROL_SCALAR_FLOAT)
+typedef float ControlScalar;
+#else
+typedef double ControlScalar;
+#endif
+
+//math.h functions in the precision of their argument. The unsuffixed ones take double, so calling them
+//with a float promotes it and runs the double routine.
+inline float ScalarAbs(float Value) { return fabsf(Value); }
+inline double ScalarAbs(double Value) { return fabs(Value); }
+inline float ScalarSqrt(float Value) { return sqrtf(Value); }
+inline double ScalarSqrt(double Value) { return sqrt(Value); }
+inline float ScalarFmod(float Value, float Divisor) { return fmodf(Value, Divisor); }
+inline double ScalarFmod(double Value, double Divisor) { return fmod(Value, Divisor); }
+inline float ScalarSin(float Radians) { return sinf(Radians); }
+inline double ScalarSin(double Radians) { return sin(Radians); }
+inline float ScalarCos(float Radians) { return cosf(Radians); }
+inline double ScalarCos(double Radians) { return cos(Radians); }
+
+/// @brief Degrees to radians in the precision of the argument
+template <typename Scalar>
+inline Scalar ScalarRadians(Scalar Degrees)
+{
+    return Degrees * Scalar(M_PI / 180.0);
+}
+#endif
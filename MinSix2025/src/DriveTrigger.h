@@ -0,0 +1,48 @@
+#ifndef Drive_Trigger
+#define Drive_Trigger
+
+/// @brief Sensor condition that ends a Min6AutoDrivetrain::DriveUntil early.
+/// Build triggers with RangeBelowTrigger, StandoffTrigger, LineTrigger and ColorTrigger.
+struct DriveTrigger
+{
+    enum Kinds
+    {
+        RangeBelow,     //Distance sensor reads closer than Range, brake from there
+        Standoff,       //Distance sensor, brake so the bot comes to rest Range from the object
+        Line,           //Optical sensor brightness at or above Low, brake from there
+        Color           //Optical sensor hue inside [Low, High], brake from there
+    };
+    Kinds Kind;
+    double Range;       //[mm] RangeBelow and Standoff distance from the sensor face
+    double Low;         //Line: [%] brightness threshold, Color: [deg] lowest hue
+    double High;        //Color: [deg] highest hue, the band wraps through 0 when High < Low
+};
+
+/// @brief Fire once the distance sensor reads closer than a range
+inline DriveTrigger RangeBelowTrigger(double RangeMm)
+{
+    DriveTrigger trigger = {DriveTrigger::RangeBelow, RangeMm, 0, 0};
+    return trigger;
+}
+
+/// @brief Come to rest a set distance from the object seen by the distance sensor
+inline DriveTrigger StandoffTrigger(double StandoffMm)
+{
+    DriveTrigger trigger = {DriveTrigger::Standoff, StandoffMm, 0, 0};
+    return trigger;
+}
+
+/// @brief Fire once the optical sensor sees a line brighter than the field tiles
+inline DriveTrigger LineTrigger(double Brightness = 50)
+{
+    DriveTrigger trigger = {DriveTrigger::Line, 0, Brightness, 0};
+    return trigger;
+}
+
+/// @brief Fire once the optical sensor sees a hue inside a band
+inline DriveTrigger ColorTrigger(double LowHue, double HighHue)
+{
+    DriveTrigger trigger = {DriveTrigger::Color, 0, LowHue, HighHue};
+    return trigger;
+}
+#endif
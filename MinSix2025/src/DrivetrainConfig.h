@@ -0,0 +1,82 @@
+#include <stdint.h>
+#include <math.h>
+
+#ifndef Drivetrain_Config
+#define Drivetrain_Config
+
+//Highest Min6AutoDrivetrain::LogLevels compiled in: 0 None, 1 CallsOnly, 2 Verbose. Output above it is removed by
+//the compiler whatever Set_LogLevel asks for, so -DMINSIX_LOG_LEVEL=0 builds loops without any logging code.
+#ifndef MINSIX_LOG_LEVEL
+#define MINSIX_LOG_LEVEL 2
+#endif
+
+/// @brief Drivetrain geometry and limits, fixed when the bot is built. Declared constexpr, the unit conversions
+/// below are worked out by the compiler and Min6AutoDrivetrain starts with every field set. The Set_ functions
+/// still change any value at run time for tuning.
+struct DrivetrainConfig
+{
+    int InGearSize;             //Tooth count of the gear on the motor
+    int OutGearSize;            //Tooth count of the gear on the wheel
+    double WheelCircumference;  //[mm]
+    double TrackWidth;          //[mm] wheel center to wheel center
+    double MaxMotorRPM;         //Highest motor RPM any motion commands
+    double MinMotorRPM;         //[RPM] static friction feedforward (kS) of turning and driving
+    uint32_t ControlPeriodMs;   //Motion control loop period
+
+    /// @param inGearSize [int] motor gear tooth count
+    /// @param outGearSize [int] wheel gear tooth count
+    /// @param wheelCircumference [mm] drive wheel circumference
+    /// @param trackWidth [mm] wheel center to wheel center
+    /// @param maxMotorRPM [RPM] highest motor RPM used
+    /// @param minMotorRPM [RPM][Optional default value is 0] smallest RPM that moves the bot
+    /// @param controlPeriodMs [ms][Optional default value is 20] control loop period
+    constexpr DrivetrainConfig(int inGearSize, int outGearSize, double wheelCircumference, double trackWidth,
+                               double maxMotorRPM, double minMotorRPM = 0, uint32_t controlPeriodMs = 20)
+        : InGearSize(inGearSize)
+        , OutGearSize(outGearSize)
+        , WheelCircumference(wheelCircumference)
+        , TrackWidth(trackWidth)
+        , MaxMotorRPM(maxMotorRPM)
+        , MinMotorRPM(minMotorRPM)
+        , ControlPeriodMs(controlPeriodMs)
+    {}
+
+    /// @return true if every value can drive the bot, for a static_assert on a constexpr config
+    constexpr bool Valid() const
+    {
+        return (InGearSize > 0) && (OutGearSize > 0) && (WheelCircumference > 0) && (TrackWidth > 0)
+            && (MaxMotorRPM > 0) && (MinMotorRPM >= 0) && (MinMotorRPM < MaxMotorRPM) && (ControlPeriodMs > 0);
+    }
+
+    /// @return wheel turns per motor turn
+    constexpr double GearRatio() const
+    {
+        return (double)InGearSize / (double)OutGearSize;
+    }
+
+    /// @return [mm/deg] wheel travel per degree of motor rotation
+    constexpr double MmPerMotorDeg() const
+    {
+        return GearRatio() * WheelCircumference / 360.0;
+    }
+
+    /// @return [RPM per mm/sec] motor RPM that drives the bot at one mm per second
+    constexpr double RPMPerMmPerSec() const
+    {
+        return 1.0 / (MmPerMotorDeg() * 6.0);
+    }
+
+    /// @return [RPM per deg/sec] motor RPM that pivots the bot at one degree per second: the wheels are half a
+    /// track width from the center
+    constexpr double TurnRPMPerDegPerSec() const
+    {
+        return (TrackWidth / 2.0) * (M_PI / 180.0) * RPMPerMmPerSec();
+    }
+
+    /// @return [sec] control loop period
+    constexpr double TickSec() const
+    {
+        return ControlPeriodMs / 1000.0;
+    }
+};
+#endif
@@ -0,0 +1,147 @@
+#include <stdint.h>
+
+#ifndef Drivetrain_Hardware
+#define Drivetrain_Hardware
+
+/// @brief Drive motor used by Min6AutoDrivetrain.
+/// Velocities are motor RPM (positive = forward), positions are motor degrees.
+class IDriveMotor
+{
+    public:
+        virtual ~IDriveMotor() {}
+
+        /// @brief Spin the motor at a signed velocity
+        /// @param VelocityRPM [RPM] positive spins forward, negative spins reverse
+        virtual void Spin(double VelocityRPM) = 0;
+
+        /// @brief Stop the motor
+        virtual void Stop() = 0;
+
+        /// @brief Measured motor velocity
+        /// @return [RPM] signed velocity
+        virtual double Velocity() = 0;
+
+        /// @brief Motor encoder position
+        /// @return [deg] motor shaft degrees since the last ResetPosition
+        virtual double Position() = 0;
+
+        /// @brief Zero the motor encoder
+        virtual void ResetPosition() = 0;
+};
+
+/// @brief Inertial sensor used by Min6AutoDrivetrain. Headings are clockwise degrees.
+class IInertialSensor
+{
+    public:
+        virtual ~IInertialSensor() {}
+
+        /// @brief Start a sensor calibration
+        virtual void Calibrate() = 0;
+
+        /// @brief Is a calibration still running
+        virtual bool IsCalibrating() = 0;
+
+        /// @brief Current heading
+        /// @return [deg] heading in the range [0, 360)
+        virtual double Heading() = 0;
+
+        /// @brief Current rotation, not wrapped to [0, 360)
+        /// @return [deg] accumulated rotation
+        virtual double Rotation() = 0;
+};
+
+/// @brief Range sensor looking along the drive direction, used by DriveUntil
+class IDistanceSensor
+{
+    public:
+        virtual ~IDistanceSensor() {}
+
+        /// @brief Is an object in range
+        virtual bool ObjectDetected() = 0;
+
+        /// @brief Range to the detected object
+        /// @return [mm] distance from the sensor face, only valid while ObjectDetected
+        virtual double ObjectDistanceMm() = 0;
+};
+
+/// @brief Colour sensor looking at the field floor, used by DriveUntil
+class IOpticalSensor
+{
+    public:
+        virtual ~IOpticalSensor() {}
+
+        /// @brief Hue of the surface under the sensor
+        /// @return [deg] hue in the range [0, 360)
+        virtual double Hue() = 0;
+
+        /// @brief Brightness of the surface under the sensor
+        /// @return [%] 0 = black, 100 = white
+        virtual double Brightness() = 0;
+};
+
+/// @brief Touch LED driven by StatusDisplay
+class IStatusLed
+{
+    public:
+        enum Colors
+        {
+            Off,
+            White,
+            Red,
+            Green,
+            Blue,
+            Orange,
+            Purple,
+            Yellow
+        };
+
+        virtual ~IStatusLed() {}
+
+        /// @brief Light the LED
+        /// @param Color [Colors] new colour, Off turns it off
+        virtual void SetColor(Colors Color) = 0;
+};
+
+/// @brief Brain services used by Min6AutoDrivetrain: timer, sleep and screen.
+class IBrainHardware
+{
+    public:
+        virtual ~IBrainHardware() {}
+
+        /// @brief Monotonic system time
+        /// @return [us] time since power on
+        virtual uint64_t SystemTimeUs() = 0;
+
+        /// @brief Reset the brain timer to zero
+        virtual void ResetTimer() = 0;
+
+        /// @brief Brain timer value
+        /// @return [sec] time since the last ResetTimer
+        virtual double TimerSec() = 0;
+
+        /// @brief Block the calling thread
+        /// @param TimeMs [ms] time to sleep
+        virtual void SleepMs(uint32_t TimeMs) = 0;
+
+        /// @brief Block the calling thread until an absolute system time
+        /// @param DeadlineUs [us] SystemTimeUs value to wake at, returns at once if already passed
+        virtual void SleepUntilUs(uint64_t DeadlineUs) = 0;
+
+        /// @brief Clear the whole screen
+        virtual void ScreenClear() = 0;
+
+        /// @brief Clear a single screen row
+        /// @param Row [int] screen row, 1 based
+        virtual void ScreenClearLine(int Row) = 0;
+
+        /// @brief Print text at a screen position
+        /// @param Row [int] screen row, 1 based
+        /// @param Column [int] screen column, 1 based
+        /// @param Text [char*] text to print
+        virtual void ScreenPrintAt(int Row, int Column, const char *Text) = 0;
+
+        /// @brief Battery terminal voltage
+        /// @return [V] present voltage, 0 if unknown
+        virtual double BatteryVoltage() = 0;
+};
+#endif
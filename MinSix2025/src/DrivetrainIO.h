@@ -0,0 +1,269 @@
+#include "ControlScalar.h"
+#include "DrivetrainHardware.h"
+#include "PlatformThread.h"
+#include "PoseEstimator.h"
+
+#ifndef Drivetrain_IO
+#define Drivetrain_IO
+
+/// @brief Every drivetrain sensor value used by one control tick, read once at the start of the tick
+struct DrivetrainSnapshot
+{
+    uint64_t TimeUs;        //[us] system time the snapshot was taken
+    ControlScalar Heading;          //[deg] 0-360, derived from Rotation
+    ControlScalar Rotation;         //[deg] accumulated inertial rotation
+    ControlScalar RotationRate;     //[deg/sec] filtered rate of change of Rotation, clockwise positive
+    ControlScalar RightRPM;         //Right motor velocity
+    ControlScalar LeftRPM;          //Left motor velocity
+    ControlScalar RightPosition;    //[deg] right motor encoder
+    ControlScalar LeftPosition;     //[deg] left motor encoder
+};
+
+/// @brief Per tick I/O for the drivetrain. Sample() reads each device once so the controller
+/// sees one coherent set of inputs; Command() writes both motors together and skips writes that
+/// would not change what the motors are already doing. Every sample also updates the pose estimate.
+/// One motion at a time owns the sampling from Begin() to End(); between motions SampleIfIdle() keeps the pose current.
+/// Rotation has a measured gyro bias removed; the heading is the rotation plus an offset set by ZeroHeading()
+/// or learned from the sensor on the first sample.
+class DrivetrainIO
+{
+    private:
+    IBrainHardware &m_Brain;
+    IInertialSensor &m_Inertial;
+    IDriveMotor &m_RightMotor;
+    IDriveMotor &m_LeftMotor;
+
+    DrivetrainSnapshot _snapshot;
+    ControlScalar _headingOffset;   //Heading - Rotation
+    bool _headingOffsetValid;       //False until learned on the first sample or set by ZeroHeading()
+    ControlScalar _gyroBias;        //[deg/sec] drift removed from every rotation sample
+    ControlScalar _biasBase;        //[deg] drift removed up to _biasSinceUs
+    uint64_t _biasSinceUs;
+    ControlScalar _rateFilterSec;   //[sec] low pass time constant on the rotation rate
+    ControlScalar _rightCommandRPM;
+    ControlScalar _leftCommandRPM;
+    bool _commandValid;         //False after Stop(): the next Command() must be written
+    int _skippedWrites;
+    PoseEstimator _pose;
+    PlatformMutex _lock;
+    bool _busy;                 //A motion is sampling, guarded by _lock
+    PlatformMutex _biasLock;    //Guards the bias fields: a motion samples without _lock while another task sets the bias
+
+    static ControlScalar WrapHeading(ControlScalar Heading)
+    {
+        Heading = ScalarFmod(Heading, ControlScalar(360));
+        if (Heading < 0) Heading += ControlScalar(360);
+        return Heading;
+    }
+
+    /// @brief Gyro drift accumulated since the bias was last set, call with _biasLock held
+    ControlScalar DriftAt(uint64_t TimeUs)
+    {
+        if (_gyroBias == 0) return _biasBase;
+        return _biasBase + (_gyroBias * ((ControlScalar)(int64_t)(TimeUs - _biasSinceUs) / ControlScalar(1000000)));
+    }
+
+    public:
+    DrivetrainIO(IBrainHardware &Brain, IInertialSensor &Inertial, IDriveMotor &RightMotor, IDriveMotor &LeftMotor) :
+    m_Brain(Brain),
+    m_Inertial(Inertial),
+    m_RightMotor(RightMotor),
+    m_LeftMotor(LeftMotor),
+    _headingOffset(0),
+    _headingOffsetValid(false),
+    _gyroBias(0),
+    _biasBase(0),
+    _biasSinceUs(0),
+    _rateFilterSec(ControlScalar(0.04)),
+    _rightCommandRPM(0),
+    _leftCommandRPM(0),
+    _commandValid(false),
+    _skippedWrites(0),
+    _busy(false)
+    {
+        _snapshot.TimeUs = 0;
+        _snapshot.Heading = 0;
+        _snapshot.Rotation = 0;
+        _snapshot.RotationRate = 0;
+        _snapshot.RightRPM = 0;
+        _snapshot.LeftRPM = 0;
+        _snapshot.RightPosition = 0;
+        _snapshot.LeftPosition = 0;
+    }
+
+    /// @brief Start of a motion: take over the sampling from SampleIfIdle(). Only one motion owns it at a time; a caller
+    /// that gets false must not Sample(), Command(), Stop() or End().
+    /// @return [bool] false if another motion already owns the sampling
+    bool Begin()
+    {
+        _lock.Lock();
+        bool owner = !_busy;
+        _busy = true;
+        _lock.Unlock();
+        return owner;
+    }
+
+    /// @brief Read every drivetrain sensor once
+    /// @return [DrivetrainSnapshot] the new snapshot
+    const DrivetrainSnapshot &Sample()
+    {
+        uint64_t lastTimeUs = _snapshot.TimeUs;
+        ControlScalar lastRotation = _snapshot.Rotation;
+        _snapshot.TimeUs = m_Brain.SystemTimeUs();
+        _biasLock.Lock();
+        ControlScalar drift = DriftAt(_snapshot.TimeUs);
+        _biasLock.Unlock();
+        _snapshot.Rotation = (ControlScalar)m_Inertial.Rotation() - drift;
+        if (!_headingOffsetValid)
+        {
+            _headingOffset = (ControlScalar)m_Inertial.Heading() - _snapshot.Rotation;
+            _headingOffsetValid = true;
+        }
+
+        //Rate from consecutive samples, no extra device read
+        if ((lastTimeUs > 0) && (_snapshot.TimeUs > lastTimeUs))
+        {
+            ControlScalar dt = (ControlScalar)(_snapshot.TimeUs - lastTimeUs) / ControlScalar(1000000);
+            ControlScalar rawRate = (_snapshot.Rotation - lastRotation) / dt;
+            _snapshot.RotationRate += (rawRate - _snapshot.RotationRate) * (dt / (_rateFilterSec + dt));
+        }
+        _snapshot.Heading = WrapHeading(_snapshot.Rotation + _headingOffset);
+        _snapshot.RightRPM = (ControlScalar)m_RightMotor.Velocity();
+        _snapshot.LeftRPM = (ControlScalar)m_LeftMotor.Velocity();
+        _snapshot.RightPosition = (ControlScalar)m_RightMotor.Position();
+        _snapshot.LeftPosition = (ControlScalar)m_LeftMotor.Position();
+        _pose.Update(_snapshot.LeftPosition, _snapshot.RightPosition, _snapshot.Rotation, _snapshot.Heading);
+        return _snapshot;
+    }
+
+    /// @brief End of a motion: sampling goes back to SampleIfIdle()
+    void End()
+    {
+        _lock.Lock();
+        _busy = false;
+        _lock.Unlock();
+    }
+
+    /// @brief Sample() unless a motion is running, for a background task keeping the pose current
+    void SampleIfIdle()
+    {
+        _lock.Lock();
+        if (!_busy) Sample();
+        _lock.Unlock();
+    }
+
+    /// @brief Sample() unless a motion is running, for a background task that uses the readings. The snapshot is
+    /// copied under the lock: a motion or another task may sample again as soon as this returns.
+    /// @param Sampled [DrivetrainSnapshot] set to the new snapshot when one was taken
+    /// @return [bool] false if a motion owns the sampling and nothing was read
+    bool SampleIfIdle(DrivetrainSnapshot &Sampled)
+    {
+        _lock.Lock();
+        bool idle = !_busy;
+        if (idle) Sampled = Sample();
+        _lock.Unlock();
+        return idle;
+    }
+
+    /// @brief The inertial sensor has just been calibrated: drop the bias and take the heading offset before any drift.
+    /// Call with no motion running.
+    void GyroCalibrated()
+    {
+        _lock.Lock();
+        _biasLock.Lock();
+        _gyroBias = 0;
+        _biasBase = 0;
+        _biasSinceUs = m_Brain.SystemTimeUs();
+        _biasLock.Unlock();
+        _headingOffset = (ControlScalar)(m_Inertial.Heading() - m_Inertial.Rotation());
+        _headingOffsetValid = true;
+        _snapshot.TimeUs = 0;
+        _snapshot.RotationRate = 0;
+        _lock.Unlock();
+    }
+
+    /// @brief Remove a constant gyro drift from the rotation from now on. Drift already removed is kept.
+    /// Safe while a motion is sampling: the new bias applies from its next sample.
+    /// @param BiasDegPerSec [deg/sec] drift of the still sensor, clockwise positive
+    void SetGyroBias(double BiasDegPerSec)
+    {
+        _biasLock.Lock();
+        uint64_t now = m_Brain.SystemTimeUs();
+        _biasBase = DriftAt(now);
+        _biasSinceUs = now;
+        _gyroBias = (ControlScalar)BiasDegPerSec;
+        _biasLock.Unlock();
+    }
+
+    /// @return [deg/sec] drift removed from the rotation now
+    double GET_GyroBias()
+    {
+        _biasLock.Lock();
+        double bias = (double)_gyroBias;
+        _biasLock.Unlock();
+        return bias;
+    }
+
+    /// @brief Make the current heading read as Heading without touching the sensor. Call with no motion running.
+    /// @param Heading [deg] heading the bot is on now
+    void ZeroHeading(double Heading)
+    {
+        _lock.Lock();
+        _biasLock.Lock();
+        ControlScalar drift = DriftAt(m_Brain.SystemTimeUs());
+        _biasLock.Unlock();
+        ControlScalar rotation = (ControlScalar)m_Inertial.Rotation() - drift;
+        _headingOffset = (ControlScalar)Heading - rotation;
+        _headingOffsetValid = true;
+        _lock.Unlock();
+    }
+
+    /// @brief Pose estimate fed by every sample
+    PoseEstimator &Pose()
+    {
+        return _pose;
+    }
+
+    /// @brief Last snapshot taken, no device access
+    const DrivetrainSnapshot &Snapshot()
+    {
+        return _snapshot;
+    }
+
+    /// @brief Command both motors. A side whose velocity is unchanged is not written.
+    /// @param LeftRPM [RPM] signed left motor velocity
+    /// @param RightRPM [RPM] signed right motor velocity
+    void Command(ControlScalar LeftRPM, ControlScalar RightRPM)
+    {
+        if (!_commandValid || (ScalarAbs(LeftRPM - _leftCommandRPM) > ControlScalar(0.01)))
+        {
+            m_LeftMotor.Spin((double)LeftRPM);
+            _leftCommandRPM = LeftRPM;
+        }
+        else
+            _skippedWrites++;
+        if (!_commandValid || (ScalarAbs(RightRPM - _rightCommandRPM) > ControlScalar(0.01)))
+        {
+            m_RightMotor.Spin((double)RightRPM);
+            _rightCommandRPM = RightRPM;
+        }
+        else
+            _skippedWrites++;
+        _commandValid = true;
+    }
+
+    /// @brief Stop both motors
+    void Stop()
+    {
+        m_RightMotor.Stop();
+        m_LeftMotor.Stop();
+        _commandValid = false;
+    }
+
+    /// @return [int] motor writes skipped because the command had not changed
+    int GET_SkippedWrites()
+    {
+        return _skippedWrites;
+    }
+};
+#endif
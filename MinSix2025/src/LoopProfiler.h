@@ -0,0 +1,254 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "DrivetrainHardware.h"
+#include "ControlLoopTimer.h"
+
+#ifndef Loop_Profiler
+#define Loop_Profiler
+
+/// @brief Summary of one LoopProfiler phase
+struct LoopPhaseStats
+{
+    uint32_t Count;     //Ticks recorded
+    uint32_t MinUs;
+    uint32_t MeanUs;
+    uint32_t P99Us;     //Upper edge of the histogram bucket holding the 99th percentile, at most MaxUs
+    uint32_t MaxUs;
+};
+
+/// @brief Per tick timing of the drivetrain control loops. The loop brackets each tick with BeginTick and
+/// EndTick, through LoopTickTimer, and times the sensor reads, motor writes and telemetry with LoopPhaseTimer; compute is the rest of
+/// the tick. Every phase feeds a fixed bucket histogram, so recording a tick is a few adds and no allocation.
+/// Attach with Min6AutoDrivetrain::Set_LOOP_PROFILER; a drivetrain without one skips all timing.
+/// Read the results between motions, the control task writes them without a lock.
+class LoopProfiler
+{
+    public:
+        enum Phases
+        {
+            Sense,      //Sensor snapshot and trigger sensor reads
+            Compute,    //Profile, feedforward, PID and steering: the tick less the other phases
+            Actuate,    //Motor writes
+            Log,        //Telemetry records
+            Work,       //Whole tick, BeginTick to EndTick
+            Period,     //Time between tick starts as paced by ControlLoopTimer
+            PhaseCount
+        };
+
+        //Buckets are 1us wide below 8us, then 8 per doubling (12.5% wide) up to about 1s
+        static const int SubBuckets = 8;
+        static const int Octaves = 20;
+        static const int BucketCount = (Octaves - 2) * SubBuckets;
+
+    private:
+        struct Histogram
+        {
+            uint32_t Buckets[BucketCount];
+            uint32_t Count;
+            uint32_t MinUs;
+            uint32_t MaxUs;
+            uint64_t TotalUs;
+        };
+
+        IBrainHardware &m_Clock;
+        Histogram _phases[PhaseCount];
+        uint32_t _budgetUs;                 //Tick work above this is an overrun
+        uint32_t _overruns;                 //Ticks whose work ran past the budget
+        uint32_t _lateTicks;                //Ticks that started after their deadline
+        uint64_t _tickStartUs;
+        uint32_t _tickUs[PhaseCount];       //Sense, Actuate and Log time summed over the current tick
+
+        static int BucketOf(uint32_t Us)
+        {
+            if (Us < SubBuckets) return (int)Us;
+            if ((Us >> Octaves) != 0) return BucketCount - 1;
+            int octave = 3;
+            while ((Us >> (octave + 1)) != 0) octave++;
+            return ((octave - 2) * SubBuckets) + (int)((Us >> (octave - 3)) & (SubBuckets - 1));
+        }
+
+        /// @return [us] first value past a bucket
+        static uint32_t BucketTop(int Bucket)
+        {
+            if (Bucket < SubBuckets) return (uint32_t)Bucket + 1;
+            int octave = (Bucket / SubBuckets) + 2;
+            uint32_t sub = (uint32_t)(Bucket % SubBuckets);
+            return (SubBuckets + sub + 1) << (octave - 3);
+        }
+
+        void Add(Phases Phase, uint32_t Us)
+        {
+            Histogram &histogram = _phases[Phase];
+            histogram.Buckets[BucketOf(Us)]++;
+            if ((histogram.Count == 0) || (Us < histogram.MinUs)) histogram.MinUs = Us;
+            if (Us > histogram.MaxUs) histogram.MaxUs = Us;
+            histogram.TotalUs += Us;
+            histogram.Count++;
+        }
+
+    public:
+        /// @param Clock [IBrainHardware] time source
+        LoopProfiler(IBrainHardware &Clock) : m_Clock(Clock), _budgetUs(0), _tickStartUs(0)
+        {
+            Reset();
+        }
+
+        /// @brief Clear every histogram and counter
+        void Reset()
+        {
+            memset(_phases, 0, sizeof(_phases));
+            memset(_tickUs, 0, sizeof(_tickUs));
+            _overruns = 0;
+            _lateTicks = 0;
+        }
+
+        /// @brief Start of a control tick
+        /// @param BudgetUs [us] control period, tick work past it counts as an overrun
+        void BeginTick(uint32_t BudgetUs)
+        {
+            _budgetUs = BudgetUs;
+            _tickUs[Sense] = 0;
+            _tickUs[Actuate] = 0;
+            _tickUs[Log] = 0;
+            _tickStartUs = m_Clock.SystemTimeUs();
+        }
+
+        /// @brief Add time to a phase of the current tick, see LoopPhaseTimer
+        void AddPhase(Phases Phase, uint32_t Us)
+        {
+            _tickUs[Phase] += Us;
+        }
+
+        /// @brief End of a control tick, before the loop sleeps
+        /// @param PeriodUs [us] time since the previous tick started, 0 on the first tick of a motion
+        /// @param OnTime [bool] false if the tick started after its deadline
+        void EndTick(uint32_t PeriodUs, bool OnTime)
+        {
+            uint32_t work = (uint32_t)(m_Clock.SystemTimeUs() - _tickStartUs);
+            uint32_t measured = _tickUs[Sense] + _tickUs[Actuate] + _tickUs[Log];
+            Add(Sense, _tickUs[Sense]);
+            Add(Actuate, _tickUs[Actuate]);
+            Add(Log, _tickUs[Log]);
+            Add(Compute, (work > measured) ? (work - measured) : 0);
+            Add(Work, work);
+            if (PeriodUs > 0) Add(Period, PeriodUs);
+            if ((_budgetUs > 0) && (work > _budgetUs)) _overruns++;
+            if (!OnTime) _lateTicks++;
+        }
+
+        /// @return [LoopPhaseStats] count, min, mean, p99 and max of a phase in us
+        LoopPhaseStats GET_Stats(Phases Phase)
+        {
+            const Histogram &histogram = _phases[Phase];
+            LoopPhaseStats stats;
+            stats.Count = histogram.Count;
+            stats.MinUs = histogram.MinUs;
+            stats.MaxUs = histogram.MaxUs;
+            stats.MeanUs = (histogram.Count > 0) ? (uint32_t)(histogram.TotalUs / histogram.Count) : 0;
+            stats.P99Us = 0;
+            uint32_t rank = histogram.Count - (histogram.Count / 100);
+            uint32_t seen = 0;
+            for (int b = 0; (b < BucketCount) && (histogram.Count > 0); b++)
+            {
+                seen += histogram.Buckets[b];
+                if (seen >= rank)
+                {
+                    stats.P99Us = BucketTop(b) - 1;
+                    break;
+                }
+            }
+            if (stats.P99Us > stats.MaxUs) stats.P99Us = stats.MaxUs;
+            return stats;
+        }
+
+        /// @return [int] ticks whose work took longer than the control period
+        uint32_t GET_Overruns()
+        {
+            return _overruns;
+        }
+
+        /// @return [int] ticks that started after their deadline
+        uint32_t GET_LateTicks()
+        {
+            return _lateTicks;
+        }
+
+        /// @brief Print a table of every phase and the counters
+        void Dump()
+        {
+            static const char *names[PhaseCount] = {"Sense", "Compute", "Actuate", "Log", "Work", "Period"};
+            printf("Loop profile: %lu ticks, %lu overruns past %luus, %lu late starts\n",
+                (unsigned long)_phases[Work].Count, (unsigned long)_overruns, (unsigned long)_budgetUs, (unsigned long)_lateTicks);
+            printf("%-8s %8s %8s %8s %8s\n", "Phase", "min us", "mean us", "p99 us", "max us");
+            for (int p = 0; p < PhaseCount; p++)
+            {
+                LoopPhaseStats stats = GET_Stats((Phases)p);
+                printf("%-8s %8lu %8lu %8lu %8lu\n", names[p],
+                    (unsigned long)stats.MinUs, (unsigned long)stats.MeanUs, (unsigned long)stats.P99Us, (unsigned long)stats.MaxUs);
+            }
+        }
+
+        /// @brief Clock the phase timers read
+        IBrainHardware &Clock()
+        {
+            return m_Clock;
+        }
+};
+
+/// @brief Scoped timer: adds the time from construction to destruction to a phase of the current tick.
+/// Does nothing, not even a clock read, when Profiler is 0.
+class LoopPhaseTimer
+{
+    private:
+        LoopProfiler *m_Profiler;
+        LoopProfiler::Phases _phase;
+        uint64_t _startUs;
+
+    public:
+        LoopPhaseTimer(LoopProfiler *Profiler, LoopProfiler::Phases Phase) : m_Profiler(Profiler), _phase(Phase), _startUs(0)
+        {
+            if (m_Profiler != 0) _startUs = m_Profiler->Clock().SystemTimeUs();
+        }
+
+        ~LoopPhaseTimer()
+        {
+            if (m_Profiler != 0) m_Profiler->AddPhase(_phase, (uint32_t)(m_Profiler->Clock().SystemTimeUs() - _startUs));
+        }
+};
+
+/// @brief Scoped control tick: BeginTick on construction, EndTick from End() before the loop sleeps, or from the
+/// destructor when the loop breaks out mid tick, so the last tick of every motion is recorded and the profiler
+/// never stays inside a tick. Does nothing when Profiler is 0.
+class LoopTickTimer
+{
+    private:
+        LoopProfiler *m_Profiler;
+        ControlLoopTimer &m_Loop;
+        const bool &_onTime;
+
+    public:
+        /// @param Profiler [LoopProfiler*] profiler to record into, 0 for none
+        /// @param Loop [ControlLoopTimer] pacing of the loop, gives the period since the previous tick
+        /// @param OnTime [bool&] the loop's flag for a tick that started after its deadline, read when the tick ends
+        /// @param BudgetUs [us] control period, tick work past it counts as an overrun
+        LoopTickTimer(LoopProfiler *Profiler, ControlLoopTimer &Loop, const bool &OnTime, uint32_t BudgetUs)
+            : m_Profiler(Profiler), m_Loop(Loop), _onTime(OnTime)
+        {
+            if (m_Profiler != 0) m_Profiler->BeginTick(BudgetUs);
+        }
+
+        /// @brief End the tick, once
+        void End()
+        {
+            if (m_Profiler == 0) return;
+            m_Profiler->EndTick((m_Loop.GET_TickCount() > 0) ? m_Loop.GET_LastDtUs() : 0, _onTime);
+            m_Profiler = 0;
+        }
+
+        ~LoopTickTimer()
+        {
+            End();
+        }
+};
+#endif
@@ -1,206 +1,1520 @@
-/*----------------------------------------------------------------------------*/
-/*                                                                            */
-/*    Module:       MinSixAutoDrivetrain.cpp                                    */
-/*    Author:       Raiford G. Bonnell                                        */
-/*    Created:      3/28/2025, 7:51:13 PM                                     */
-/*    Description:  Drivetrain library for 6 wheel IQ drivetrain              */
-/*                                                                            */
-/*----------------------------------------------------------------------------*/
-#include "vex.h"
-#include "MinSixAutoDrivetrain.h"
-#include "PIDController.h"
-#include "MotionAccelerator.h"
-
-void Min6AutoDrivetrain::CalibrateGyro()
-{
-    if (_logLevel > LogLevels::None) printf("[CalibrateGyro]\n");
-    vex::wait(250, vex::timeUnits::msec);
-    m_Brain.Timer.reset();
-    m_Brain.Screen.setCursor(1, 1);
-    m_Brain.Screen.print("Calibrating...");
-    if (_logLevel == LogLevels::Verbose) printf("Start Calibration\n");
-    
-    m_BrainInertial.calibrate();
-    while (m_BrainInertial.isCalibrating()) 
-    {
-        vex::wait(250, vex::timeUnits::msec);
-    }
-    m_Brain.Screen.clearScreen();
-    m_Brain.Screen.setCursor(1, 1);
-    m_Brain.Screen.print("Ready");
-    if (_logLevel == LogLevels::Verbose) printf("End Calibration after %f seconds\n", m_Brain.Timer.value());
-
-    return;
-}
-
-/// @brief Turn Bot to desired heading if the bots current heading is not within the heading toleracne.
-/// @param Heading [Degrees]The desired heading for the bot.
-/// @param TurnVelocity [RPM]The top motor RPM to be used during the turn.
-/// @param TimeOut [ms]Time allotted to complete the turn.
-/// @param HeadingTolerance [deg]Allowed error in turn.
-/// @param AccertionSteps [int][Optional default value is 10]Number of steps to be used to bring motors up to speed.
-void Min6AutoDrivetrain::TurnToHeading(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps)
-{
-    if (_logLevel > LogLevels::None)
-    {
-        printf("-----[TurnToHeading]-----\n");
-        printf("Heading: %f\n", Heading);
-        printf("TurnVelocity: %f\n", TurnVelocity);
-        printf("TimeOut: %f\n", TimeOut);
-        printf("HeadingTolerance: %f\n", HeadingTolerance);
-        printf("-------------------------\n");
-    }
-
-    //Is bot current heading within tolerance?
-    bool IsTurnRequired = false;
-    int CurrentQuad = GetQuad(m_BrainInertial.heading(vex::rotationUnits::deg));
-    int DesiredQuad = GetQuad(Heading);
-    if (_logLevel == LogLevels::Verbose)
-    {
-        printf("CurrentQuad: %d\n", CurrentQuad);
-        printf("DesiredQuad: %d\n", DesiredQuad);
-    }
-    if ((CurrentQuad == 4) && (DesiredQuad == 1))
-    {
-        IsTurnRequired = (((360 - m_BrainInertial.heading(vex::rotationUnits::deg) + Heading)) > HeadingTolerance);
-    }
-    else
-    {    
-        if ((CurrentQuad == 1) && (DesiredQuad == 4))
-        {
-            IsTurnRequired = (((360 - Heading) + m_BrainInertial.heading(vex::rotationUnits::deg)) > HeadingTolerance);
-        }
-        else
-        {
-            IsTurnRequired = ((abs(Heading - m_BrainInertial.heading(vex::rotationUnits::deg))) > HeadingTolerance);    
-        }
-    }
-    if (IsTurnRequired)
-    {
-        //Setup PID signal Calculater
-        PIDController pid(1.0f, 0.0f, 0.0f);
-
-        //Setup Acceration control
-        MotionAccelerator ma(AccertionSteps, 1000, 0, TurnVelocity, _minMotorRPM);
-
-        //Calculate Turn amount and direction
-        double d1 = abs(Heading - m_BrainInertial.heading(vex::rotationUnits::deg));
-        double d2 = 360 - d1;
-        double CWTurnAmount = 0.0f;
-        double CCWTurnAmount = 0.0f;
-        if (m_BrainInertial.heading(vex::rotationUnits::deg) < Heading)
-        {
-            CWTurnAmount = d1;
-            CCWTurnAmount = d2;
-        }
-        else
-        {
-            CWTurnAmount = d2;
-            CCWTurnAmount = d1;
-        }
-        if (_logLevel == LogLevels::Verbose)
-        {
-            printf("CWTurnAmount: %f\n", CWTurnAmount);
-            printf("CCWTurnAmount: %f\n", CCWTurnAmount);
-        }
-        //Zero out bot rotation
-        m_BrainInertial.setRotation(0, vex::rotationUnits::rev);
-        if (CWTurnAmount < CCWTurnAmount)
-        {
-            m_Brain.resetTimer();
-            if (_logLevel > LogLevels::None) printf("Turn Clockwise\n");
-            if (_logLevel == LogLevels::Verbose) printf("Requested, Right Actual, Left Actual, Heading\n");
-            m_RightDriveMotor.spin(vex::directionType::rev);
-            m_LeftDriveMotor.spin(vex::directionType::fwd);
-            while (m_BrainInertial.rotation(vex::rotationUnits::deg) < CWTurnAmount)
-            {
-                double MotorVelocity;
-                if (ma.GET_StepCount() < AccertionSteps)
-                    MotorVelocity = ma.GetNextStepRPM();
-                else
-                    MotorVelocity = ((pid.calculateControlSignal(abs(CWTurnAmount - m_BrainInertial.rotation(vex::rotationUnits::deg)))) / CWTurnAmount) * TurnVelocity;
-                if (MotorVelocity < _minMotorRPM) MotorVelocity = _minMotorRPM;
-                m_RightDriveMotor.setVelocity((MotorVelocity * -1), vex::velocityUnits::rpm);
-                m_LeftDriveMotor.setVelocity(MotorVelocity, vex::velocityUnits::rpm);   
-                if (_logLevel == LogLevels::Verbose)
-                    printf("%f, %f, %f, %f\n", 
-                        MotorVelocity, 
-                        abs(m_RightDriveMotor.velocity(vex::velocityUnits::rpm)), 
-                        abs(m_LeftDriveMotor.velocity(vex::velocityUnits::rpm)),
-                        m_BrainInertial.heading(vex::rotationUnits::deg));  
-                if (m_Brain.Timer.time(vex::timeUnits::sec) > TimeOut)
-                {
-                    if (_logLevel > LogLevels::None) 
-                        printf("**TIMED OUT**\n");
-                    break;
-                }
-                wait(20, vex::timeUnits::msec);
-            }
-            m_RightDriveMotor.stop();
-            m_LeftDriveMotor.stop();
-        }
-        else
-        {
-            m_Brain.resetTimer();
-            if (_logLevel > LogLevels::None) printf("Turn Counter Clockwise\n");
-            if (_logLevel == LogLevels::Verbose) printf("Requested, Right Actual, Left Actual, Heading\n");
-            m_RightDriveMotor.spin(vex::directionType::fwd);
-            m_LeftDriveMotor.spin(vex::directionType::rev);
-            while (abs(m_BrainInertial.rotation(vex::rotationUnits::deg)) < CCWTurnAmount)
-            {
-                double MotorVelocity;
-                if (ma.GET_StepCount() < AccertionSteps)
-                    MotorVelocity = ma.GetNextStepRPM();
-                else
-                    MotorVelocity = ((pid.calculateControlSignal(abs(CCWTurnAmount - abs(m_BrainInertial.rotation(vex::rotationUnits::deg))))) / CCWTurnAmount) * TurnVelocity;
-                if (MotorVelocity < _minMotorRPM) MotorVelocity = _minMotorRPM;
-                m_RightDriveMotor.setVelocity(MotorVelocity, vex::velocityUnits::rpm);
-                m_LeftDriveMotor.setVelocity((MotorVelocity * -1), vex::velocityUnits::rpm);   
-                if (_logLevel == LogLevels::Verbose)
-                    printf("%f, %f, %f, %f, %f\n", 
-                        MotorVelocity, 
-                        abs(m_RightDriveMotor.velocity(vex::velocityUnits::rpm)), 
-                        abs(m_LeftDriveMotor.velocity(vex::velocityUnits::rpm)),
-                        m_BrainInertial.heading(vex::rotationUnits::deg),  
-                        m_BrainInertial.rotation(vex::rotationUnits::deg));
-                if (m_Brain.Timer.time(vex::timeUnits::sec) > TimeOut)
-                {
-                    if (_logLevel > LogLevels::None) 
-                        printf("**TIMED OUT**\n");
-                    break;
-                }
-                wait(20, vex::timeUnits::msec);
-            }
-            m_RightDriveMotor.stop();
-            m_LeftDriveMotor.stop();
-        }
-        if (_logLevel > LogLevels::None) 
-        {
-            printf("Final Heading: %f degress\n", m_BrainInertial.heading(vex::rotationUnits::deg));
-            printf("Time To Complete: %fs\n", m_Brain.Timer.time(vex::timeUnits::sec));
-        }
-    }
-    else
-    {
-        if (_logLevel > LogLevels::None) printf("No turn needed\n");
-    }
-
-    return;
-}
-
-/// @brief Utility function to calculate which quadrent the given heading is in.
-/// @param Heading [Dgrees]Heading to evaluate.
-/// @return integer repersenting the quadrent.
-int Min6AutoDrivetrain::GetQuad(double Heading)
-{
-    if ((Heading >= 0) && (Heading <= 90))
-        return 1;
-    if ((Heading > 90) && (Heading <= 180))
-        return 2;
-    if ((Heading > 180) && (Heading <= 270))
-        return 3;
-    if ((Heading > 270) && (Heading < 360))
-        return 4;
-
-    return 0;
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       MinSixAutoDrivetrain.cpp                                    */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      3/28/2025, 7:51:13 PM                                     */
+/*    Description:  Drivetrain library for 6 wheel IQ drivetrain              */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "MinSixAutoDrivetrain.h"
+#include "PIDController.h"
+#include "MotionProfile.h"
+#include "ControlLoopTimer.h"
+
+/// @brief Calibrate the inertial sensor, blocking until it is ready. The bot must be still.
+/// @param Quick [bool][Optional default value is false] only zero the heading, reusing the calibration and the gyro
+/// bias measured earlier in this power cycle. Runs a full calibration if there has not been one.
+void Min6AutoDrivetrain::CalibrateGyro(bool Quick)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("[CalibrateGyro%s]\n", Quick ? " Quick" : "");
+    _gyroReady = false;
+    //System time, not the brain timer: motions own the timer and this may run on the gyro task
+    uint64_t StartUs = m_Brain.SystemTimeUs();
+
+    if (Quick && _gyroCalibrated)
+    {
+        if (_gyroBiasValid) m_IO.SetGyroBias(_gyroBias);
+        m_IO.ZeroHeading(0);
+        if (Logging(LogLevels::Verbose)) printf("Heading zeroed, gyro bias %f deg/sec\n", _gyroBias);
+    }
+    else
+    {
+        if (m_Status != 0) m_Status->SetRow(1, "Calibrating...");
+        if (Logging(LogLevels::Verbose)) printf("Start Calibration\n");
+
+        _gyroBiasValid = false;
+        m_BrainInertial.Calibrate();
+        while (m_BrainInertial.IsCalibrating()) 
+        {
+            m_Brain.SleepMs(GyroPollMs);
+        }
+        m_IO.GyroCalibrated();
+        _gyroCalibrated = true;
+    }
+    if (m_Status != 0) m_Status->SetRow(1, "Ready");
+    if (Logging(LogLevels::Verbose)) printf("End Calibration after %f seconds\n", (m_Brain.SystemTimeUs() - StartUs) / 1000000.0);
+    _gyroReady = true;
+
+    return;
+}
+
+/// @brief Measure the drift of the still inertial sensor and remove it from the rotation from now on. The bias is
+/// kept for CalibrateGyro(true). Gives up if a motion starts, a wheel turns or a calibration starts while measuring.
+/// @param SampleSec [sec][Optional default value is 2] measuring time, longer averages out more gyro noise
+/// @return [bool] true if the bias was measured
+bool Min6AutoDrivetrain::MeasureGyroBias(double SampleSec)
+{
+    //Least squares slope of rotation against time
+    uint64_t StartUs = m_Brain.SystemTimeUs();
+    double St = 0, Sr = 0, Stt = 0, Str = 0;
+    int Samples = 0;
+    double Elapsed = 0;
+    while (Elapsed < SampleSec)
+    {
+        //Read through the drivetrain I/O like every other sample, refused in the same lock a motion takes it in
+        DrivetrainSnapshot sensors;
+        if (!_gyroReady || !m_IO.SampleIfIdle(sensors)) return false;
+        if ((ScalarAbs(sensors.RightRPM) > ControlScalar(0.5)) || (ScalarAbs(sensors.LeftRPM) > ControlScalar(0.5))) return false;
+        Elapsed = (sensors.TimeUs - StartUs) / 1000000.0;
+        double Rotation = (double)sensors.Rotation;
+        St += Elapsed;
+        Sr += Rotation;
+        Stt += Elapsed * Elapsed;
+        Str += Elapsed * Rotation;
+        Samples++;
+        m_Brain.SleepMs(GyroPollMs);
+    }
+    double Denominator = (Samples * Stt) - (St * St);
+    if ((Samples < 2) || (Denominator <= 0)) return false;
+
+    //The sampled rotation already has the bias in use removed, the slope is what is left of the drift
+    _gyroBias = m_IO.GET_GyroBias() + (((Samples * Str) - (St * Sr)) / Denominator);
+    _gyroBiasValid = true;
+    m_IO.SetGyroBias(_gyroBias);
+    if (Logging(LogLevels::Verbose)) printf("Gyro bias %f deg/sec from %d samples\n", _gyroBias, Samples);
+    return true;
+}
+
+/// @brief Body of the gyro task: run requested calibrations, measuring the bias after each full one once the bot is still
+int Min6AutoDrivetrain::GyroTaskEntry(void *Arg)
+{
+    Min6AutoDrivetrain *drivetrain = (Min6AutoDrivetrain *)Arg;
+    while (true)
+    {
+        int request = drivetrain->_gyroRequest.exchange(GyroNone);
+        if (request == GyroNone)
+        {
+            PlatformSleepMs(GyroPollMs);
+            continue;
+        }
+        drivetrain->CalibrateGyro(request == GyroQuick);
+
+        //A motion or a turning wheel only puts the bias measurement off until the bot is idle and still again,
+        //otherwise a routine started while measuring would run the whole match without it. A new request takes over.
+        bool Interrupted = false;
+        while (!drivetrain->_gyroBiasValid && (drivetrain->_gyroRequest == GyroNone))
+        {
+            if (drivetrain->MeasureGyroBias()) break;
+            if (!Interrupted && drivetrain->Logging(LogLevels::CallsOnly)) printf("Gyro bias measurement interrupted, retrying when the bot is still\n");
+            Interrupted = true;
+            PlatformSleepMs(GyroPollMs);
+        }
+    }
+    return 0;
+}
+
+/// @brief Calibrate the inertial sensor on a background task and return at once, so start up work runs
+/// alongside it. IsGyroReady() reports when it is done. The bot must be still.
+/// @param Quick [bool][Optional default value is false] see CalibrateGyro
+void Min6AutoDrivetrain::StartGyroCalibration(bool Quick)
+{
+    _gyroReady = false;
+    _gyroRequest = Quick ? GyroQuick : GyroFull;
+    _gyroTask.Start(GyroTaskEntry, this, PlatformTask::Normal);
+}
+
+/// @brief Has the inertial sensor finished calibrating, safe to call from any task
+/// @return [bool] true once headings can be trusted
+bool Min6AutoDrivetrain::IsGyroReady()
+{
+    return _gyroReady;
+}
+
+/// @brief Fixed rate control loop shared by every motion. Each tick is profiled, samples the drivetrain once and
+/// hands the snapshot to Tick unless the motion was cancelled; the loop ends when Tick returns false or on the time out.
+/// @param loop [ControlLoopTimer] paces the ticks, started here, for LogMotionEnd afterwards
+/// @param CancelCount [uint32_t] _cancelCount when the motion was started, a cancel changes it and stops the loop
+/// @param TimeOut [sec] time allotted to the motion
+/// @param Tick [bool(const DrivetrainSnapshot &, bool OnTime)] body of one tick, returns false when the motion is done
+template <typename TickBody>
+void Min6AutoDrivetrain::RunControlLoop(ControlLoopTimer &loop, uint32_t CancelCount, ControlScalar TimeOut, TickBody Tick)
+{
+    _motionCount++;
+    m_Brain.ResetTimer();
+    loop.Start();
+    bool onTime = true;
+    while (true)
+    {
+        LoopTickTimer tick(m_Profiler, loop, onTime, _controlPeriodMs * 1000);
+        const DrivetrainSnapshot &sensors = SampleSensors();
+        if (_cancelCount != CancelCount)
+        {
+            if (Logging(LogLevels::CallsOnly)) 
+                printf("**CANCELLED**\n");
+            break;
+        }
+        if (!Tick(sensors, onTime)) break;
+        if ((ControlScalar)m_Brain.TimerSec() > TimeOut)
+        {
+            if (Logging(LogLevels::CallsOnly)) 
+                printf("**TIMED OUT**\n");
+            break;
+        }
+        tick.End();
+        onTime = loop.WaitForNextTick();
+    }
+}
+
+/// @brief Turn Bot to desired heading if the bots current heading is not within the heading toleracne.
+/// @param Heading [Degrees]The desired heading for the bot.
+/// @param TurnVelocity [RPM]The top motor RPM to be used during the turn.
+/// @param TimeOut [sec]Time allotted to complete the turn.
+/// @param HeadingTolerance [deg]Allowed error in turn.
+/// @param AccertionSteps [int][Optional default value is 10]Number of control periods used to bring motors up to speed.
+void Min6AutoDrivetrain::TurnToHeading(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps)
+{
+    TurnSegment(Heading, TurnVelocity, TimeOut, HeadingTolerance, AccertionSteps, true, _cancelCount);
+}
+
+/// @brief TurnToHeading body
+/// @param StopAtEnd [bool] false leaves the motors to the next segment of a routine
+/// @param CancelCount [uint32_t] _cancelCount when the motion was started, a cancel changes it and stops the motion
+void Min6AutoDrivetrain::TurnSegment(ControlScalar Heading, ControlScalar TurnVelocity, ControlScalar TimeOut, ControlScalar HeadingTolerance, int AccertionSteps, bool StopAtEnd,
+                                     uint32_t CancelCount)
+{
+    if (Logging(LogLevels::CallsOnly))
+    {
+        printf("-----[TurnToHeading]-----\n");
+        printf("Heading: %f\n", (double)Heading);
+        printf("TurnVelocity: %f\n", (double)TurnVelocity);
+        printf("TimeOut: %f\n", (double)TimeOut);
+        printf("HeadingTolerance: %f\n", (double)HeadingTolerance);
+        printf("-------------------------\n");
+    }
+
+    //One coherent read of the bot's starting heading, then the signed shortest turn to the target
+    if (!BeginMotion()) return;
+    const DrivetrainSnapshot &start = m_IO.Sample();
+    ControlScalar StartHeading = start.Heading;
+    ControlScalar StartRotation = start.Rotation;
+    _motionStartRotation = StartRotation;
+    _motionKind = TelemetryTurn;
+    m_IO.Pose().SetGeometry(_mmPerMotorDeg);
+    ControlScalar Boost = UpdateBatteryCompensation();
+    ControlScalar TurnAmount = HeadingError(Heading, StartHeading);
+    if (Logging(LogLevels::Verbose))
+    {
+        printf("StartHeading: %f\n", (double)StartHeading);
+        printf("TurnAmount: %f\n", (double)TurnAmount);
+    }
+
+    //Is bot current heading within tolerance?
+    if (ScalarAbs(TurnAmount) > HeadingTolerance)
+    {
+        //Setup PID signal Calculater, correcting the bot's rotation against the profile [RPM per degree]. It also
+        //reports when the turn has settled, see Set_TURN_SETTLE.
+        PIDController pid(_turnKp, _turnKi, _turnKd);
+        pid.setOutputLimits(-TurnVelocity, TurnVelocity);
+        pid.setIntegralLimit(TurnVelocity / 4);
+        pid.setDerivativeFilter(2 * _tickSec);
+        pid.setSettleCriteria(HeadingTolerance, _turnSettleRate, _turnSettleTime);
+
+        //Setup Acceration control: reach TurnVelocity after AccertionSteps control periods
+        ControlScalar rpmPerDegPerSec = _turnRPMPerDegPerSec;
+        ControlScalar Kv = (_turnKv > 0) ? _turnKv : rpmPerDegPerSec;
+        ControlScalar TickSec = _tickSec;
+        ControlScalar accelerationTime = AccertionSteps * _tickSec;
+        if (accelerationTime <= 0) accelerationTime = _tickSec;
+        MotionProfile profile;
+        profile.Plan(TurnAmount,
+                     TurnVelocity / rpmPerDegPerSec,
+                     (TurnVelocity / rpmPerDegPerSec) / accelerationTime,
+                     _turnJerk / rpmPerDegPerSec);
+        if (Logging(LogLevels::Verbose)) printf("Profile Duration: %f\n", (double)profile.GET_Duration());
+
+        //Rotation is measured from the start of the turn, the target is TurnAmount: positive clockwise, negative counter clockwise.
+        //The inertial rotation itself is never rewritten so the pose estimate sees one continuous rotation.
+        ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+        bool Kicked = false;
+        if (Logging(LogLevels::CallsOnly)) printf((TurnAmount > 0) ? "Turn Clockwise\n" : "Turn Counter Clockwise\n");
+        RunControlLoop(loop, CancelCount, TimeOut, [&](const DrivetrainSnapshot &sensors, bool onTime) -> bool
+        {
+            ControlScalar Elapsed = loop.ElapsedSec();
+            ControlScalar Rotation = sensors.Rotation - StartRotation;
+
+            //Signed error to the target. It changes sign on an overshoot so the bot turns back.
+            ControlScalar Error = TurnAmount - Rotation;
+
+            //Profile feedforward plus feedback on the tracking error. The command holds until the next sample, so the
+            //feedforward is taken from the profile one tick ahead. The profile is smooth, so the derivative is taken on the
+            //tracking error too: on the rotation alone it would brake against the feedforward all through the turn.
+            ProfileState setpoint = profile.Sample(Elapsed);
+            ProfileState ahead = profile.Sample(Elapsed + TickSec);
+            ControlScalar Tracking = setpoint.Position - Rotation;
+            ControlScalar Correction = pid.calculateControlSignal(Tracking, loop.GET_LastDtSec());
+
+            //Done once the profile has finished and the tracking error has stayed in the tolerance, changing no faster
+            //than the settle rate, for the settle time. After the profile the tracking error is the error to the target.
+            if ((Elapsed >= profile.GET_Duration()) && pid.isSettled()) return false;
+            ControlScalar MotorVelocity = (ahead.Velocity * Kv) + (((ahead.Acceleration * _turnKa) + Correction) * Boost);
+
+            //Static friction: a bot at rest that should be getting under way, or that stopped outside the tolerance after
+            //the profile, gets kS on alternate ticks. Once it is moving the rest of the command brings it in, so small
+            //corrections do not turn into a limit cycle. A bot slowing down with the profile is left alone.
+            ControlScalar Push = 0;
+            if (Elapsed < profile.GET_Duration())
+                Push = ((setpoint.Acceleration * TurnAmount) >= 0) ? TurnAmount : 0;
+            else if (ScalarAbs(Error) > HeadingTolerance)
+                Push = Error;
+            bool Kick = !Kicked && (Push != 0) && (ScalarAbs(sensors.RotationRate) <= _turnSettleRate);
+            if (Kick) MotorVelocity += ((Push > 0) ? _turnKs : -_turnKs) * Boost;
+            Kicked = Kick;
+            if (MotorVelocity > _maxMotorRPM) MotorVelocity = _maxMotorRPM;
+            if (MotorVelocity < -_maxMotorRPM) MotorVelocity = -_maxMotorRPM;
+            CommandMotors(MotorVelocity, MotorVelocity * -1);
+
+            if (Logging(LogLevels::Verbose))
+                RecordTick(Heading, MotorVelocity, Elapsed, onTime);
+            return true;
+        });
+        if (StopAtEnd) m_IO.Stop();
+
+        if (Logging(LogLevels::CallsOnly)) 
+        {
+            const DrivetrainSnapshot &sensors = m_IO.Sample();
+            printf("Final Heading: %f degress\n", (double)sensors.Heading);
+            printf("Final Error: %f degress\n", (double)(TurnAmount - (sensors.Rotation - StartRotation)));
+        }
+        LogMotionEnd(loop);
+    }
+    else
+    {
+        if (Logging(LogLevels::CallsOnly)) printf("No turn needed\n");
+    }
+    m_IO.End();
+
+    return;
+}
+
+/// @brief Drive straight for a distance, holding the heading the bot started on.
+/// @param Distance [mm]Distance to travel, negative drives backwards.
+/// @param DriveVelocity [RPM]The top motor RPM to be used during the drive.
+/// @param TimeOut [sec]Time allotted to complete the drive.
+/// @param AccertionSteps [int][Optional default value is 10]Number of control periods used to bring motors up to speed.
+void Min6AutoDrivetrain::DriveDistance(double Distance, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    DriveSegment(Distance, DriveVelocity, TimeOut, AccertionSteps, 0, 0, 0, true, _cancelCount);
+}
+
+/// @brief Drive straight until a sensor condition fires, then brake under the drive acceleration and jerk limits.
+/// The sensor is polled every control tick. RangeBelow, Line and Color triggers stop as quickly as the limits allow from
+/// the tick they fire; a Standoff trigger starts braking in time to come to rest at the standoff range.
+/// @param Trigger [DriveTrigger] condition that ends the drive, its sensor must be attached with Set_FRONT_DISTANCE_SENSOR or Set_FRONT_OPTICAL_SENSOR
+/// @param MaxDistance [mm]Distance at which the drive stops if the trigger never fires, negative drives backwards.
+/// @param DriveVelocity [RPM]The top motor RPM to be used during the drive.
+/// @param TimeOut [sec]Time allotted to complete the drive.
+/// @param AccertionSteps [int][Optional default value is 10]Number of control periods used to bring motors up to speed and back to rest.
+/// @return [bool] true if the trigger fired, false if the drive ran out of distance or time or the sensor is not attached
+bool Min6AutoDrivetrain::DriveUntil(const DriveTrigger &Trigger, double MaxDistance, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    if (!TriggerSensorAttached(Trigger)) return false;
+    DriveSegment(MaxDistance, DriveVelocity, TimeOut, AccertionSteps, 0, 0, 0, true, _cancelCount, 0, &Trigger);
+    return _triggerFired;
+}
+
+/// @brief Drive forward along a circular arc, turning by Angle on the way. Left and right wheel speeds are split
+/// by the track width so the bot follows the circle, the heading is held to the angle covered so far, and the
+/// center speed is lowered so the outer wheel stays inside DriveVelocity and the sideways acceleration inside
+/// Set_MAX_LATERAL_ACCELERATION.
+/// @param Radius [mm]Radius of the arc at the center of the bot, must be positive.
+/// @param Angle [deg]Heading change over the arc, positive curves clockwise.
+/// @param DriveVelocity [RPM]The top motor RPM of the outer wheel.
+/// @param TimeOut [sec]Time allotted to complete the arc.
+/// @param AccertionSteps [int][Optional default value is 10]Number of control periods used to bring motors up to speed.
+void Min6AutoDrivetrain::ArcTurn(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    ArcSegment(Radius, Angle, DriveVelocity, TimeOut, AccertionSteps, _cancelCount);
+}
+
+/// @brief ArcTurn body
+/// @param CancelCount [uint32_t] _cancelCount when the motion was started, a cancel changes it and stops the motion
+void Min6AutoDrivetrain::ArcSegment(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps, uint32_t CancelCount)
+{
+    if ((Radius <= 0) || (Angle == 0))
+    {
+        if (Logging(LogLevels::CallsOnly)) printf("ArcTurn: radius must be positive and angle not zero\n");
+        return;
+    }
+    ControlScalar Curvature = ((Angle < 0) ? ControlScalar(-1) : ControlScalar(1)) / (ControlScalar)Radius;
+    DriveSegment(ScalarRadians((ControlScalar)(Radius * fabs(Angle))), DriveVelocity, TimeOut, AccertionSteps, 0, 0, 0, true, CancelCount, Curvature);
+}
+
+/// @brief Follow a path of field waypoints with pure pursuit, starting from the current pose. Each tick the bot
+/// steers on the arc to a point Lookahead further along the path, slowing for tight curves, for the corners ahead
+/// and to come to rest at the last waypoint.
+/// @param Points [PathPoint*] waypoints in the pose frame, see ResetPose. At most PurePursuit::MaxPoints - 1 are used.
+/// @param Count [int] number of waypoints
+/// @param DriveVelocity [RPM]The top motor RPM of either wheel.
+/// @param Lookahead [mm]How far along the path to steer toward. Shorter follows corners closer, longer is smoother.
+/// @param TimeOut [sec]Time allotted to complete the path.
+/// @param AccertionSteps [int][Optional default value is 10]Number of control periods used to bring motors up to speed and back to rest.
+/// @return [bool] true if the bot reached the end of the path, false on a time out, cancel or empty path
+bool Min6AutoDrivetrain::FollowPath(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps)
+{
+    return PathSegment(Points, Count, DriveVelocity, Lookahead, TimeOut, AccertionSteps, _cancelCount);
+}
+
+/// @brief FollowPath body
+/// @param CancelCount [uint32_t] _cancelCount when the motion was started, a cancel changes it and stops the motion
+bool Min6AutoDrivetrain::PathSegment(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps,
+                                     uint32_t CancelCount)
+{
+    if (Logging(LogLevels::CallsOnly))
+    {
+        printf("-----[FollowPath]-----\n");
+        printf("Points: %d\n", Count);
+        printf("DriveVelocity: %f\n", DriveVelocity);
+        printf("Lookahead: %f\n", Lookahead);
+        printf("TimeOut: %f\n", TimeOut);
+        printf("-------------------------\n");
+    }
+
+    if (!BeginMotion()) return false;
+    const DrivetrainSnapshot &start = m_IO.Sample();
+    _motionStartRotation = start.Rotation;
+    _motionKind = TelemetryDrive;
+    m_IO.Pose().SetGeometry(_mmPerMotorDeg);
+    ControlScalar Boost = UpdateBatteryCompensation();
+
+    //Convert between motor RPM and wheel travel
+    ControlScalar rpmPerMmPerSec = _rpmPerMmPerSec;
+    ControlScalar Kv = (_driveKv > 0) ? _driveKv : rpmPerMmPerSec;
+    ControlScalar TickSec = _tickSec;
+    ControlScalar accelerationTime = AccertionSteps * TickSec;
+    if (accelerationTime <= 0) accelerationTime = TickSec;
+    ControlScalar MaxAcceleration = ((ControlScalar)DriveVelocity / rpmPerMmPerSec) / accelerationTime;
+
+    Pose pose = m_IO.Pose().Get();
+    PurePursuit pursuit;
+    if ((Points == 0) || !pursuit.Plan(pose.X, pose.Y, Points, Count, (ControlScalar)Lookahead, _trackWidth,
+                                       (ControlScalar)DriveVelocity / rpmPerMmPerSec, MaxAcceleration, _maxLateralAcceleration))
+    {
+        if (Logging(LogLevels::CallsOnly)) printf("No path to follow\n");
+        m_IO.End();
+        return false;
+    }
+    if (Logging(LogLevels::Verbose)) printf("Path Length: %f\n", (double)pursuit.GET_Length());
+
+    ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+    bool Reached = false;
+    ControlScalar Speed = 0;    //[mm/sec] center speed command
+    RunControlLoop(loop, CancelCount, (ControlScalar)TimeOut, [&](const DrivetrainSnapshot &sensors, bool onTime) -> bool
+    {
+        pose = m_IO.Pose().Get();
+        PursuitCommand steer = pursuit.Update(pose.X, pose.Y, pose.Heading);
+        if (steer.Remaining <= 0)
+        {
+            Reached = true;
+            return false;
+        }
+
+        //Speed up at the drive acceleration toward the allowed speed, drop to it at once: the follower has
+        //already planned the braking into it
+        ControlScalar Acceleration = MaxAcceleration;
+        if ((Speed + (MaxAcceleration * TickSec)) > steer.Velocity)
+        {
+            Acceleration = (steer.Velocity - Speed) * _tickRate;
+            if (Acceleration < -MaxAcceleration) Acceleration = -MaxAcceleration;
+            Speed = steer.Velocity;
+        }
+        else
+            Speed += MaxAcceleration * TickSec;
+
+        //Center speed feedforward, then the wheels split about it for the steer curvature
+        ControlScalar MotorVelocity = (Speed * Kv) + (Acceleration * _driveKa * Boost);
+        bool AtRest = ScalarAbs(sensors.LeftRPM + sensors.RightRPM) < _driveKs;
+        if (AtRest) MotorVelocity += _driveKs * Boost;
+        if (MotorVelocity < 0) MotorVelocity = 0;
+        ControlScalar Bend = MotorVelocity * steer.Curvature * _halfTrack;
+        ControlScalar LeftRPM = MotorVelocity + Bend;
+        ControlScalar RightRPM = MotorVelocity - Bend;
+        if (LeftRPM > _maxMotorRPM) LeftRPM = _maxMotorRPM;
+        if (LeftRPM < -_maxMotorRPM) LeftRPM = -_maxMotorRPM;
+        if (RightRPM > _maxMotorRPM) RightRPM = _maxMotorRPM;
+        if (RightRPM < -_maxMotorRPM) RightRPM = -_maxMotorRPM;
+        CommandMotors(LeftRPM, RightRPM);
+
+        if (Logging(LogLevels::Verbose))
+            RecordTick(steer.Remaining, MotorVelocity, loop.ElapsedSec(), onTime);
+        return true;
+    });
+    m_IO.Stop();
+
+    if (Logging(LogLevels::CallsOnly)) 
+    {
+        m_IO.Sample();
+        pose = m_IO.Pose().Get();
+        printf("Final Pose: %f, %f mm, %f degress\n", (double)pose.X, (double)pose.Y, (double)pose.Heading);
+        printf("Path: %s\n", Reached ? "done" : "not finished");
+    }
+    LogMotionEnd(loop);
+    m_IO.End();
+
+    return Reached;
+}
+
+/// @brief Is the sensor a trigger reads attached, logging an error if not
+bool Min6AutoDrivetrain::TriggerSensorAttached(const DriveTrigger &Trigger)
+{
+    bool Range = (Trigger.Kind == DriveTrigger::RangeBelow) || (Trigger.Kind == DriveTrigger::Standoff);
+    if (Range && (m_FrontDistance == 0))
+    {
+        if (Logging(LogLevels::CallsOnly)) printf("DriveUntil: no front distance sensor, see Set_FRONT_DISTANCE_SENSOR\n");
+        return false;
+    }
+    if (!Range && (m_FrontOptical == 0))
+    {
+        if (Logging(LogLevels::CallsOnly)) printf("DriveUntil: no front optical sensor, see Set_FRONT_OPTICAL_SENSOR\n");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Read the sensor of a trigger
+/// @param RangeMm [mm] set to the distance sensor range for RangeBelow and Standoff triggers
+/// @return [bool] RangeBelow, Line and Color: the condition holds. Standoff: an object is in range.
+bool Min6AutoDrivetrain::ReadTrigger(const DriveTrigger &Trigger, ControlScalar &RangeMm)
+{
+    LoopPhaseTimer timer(m_Profiler, LoopProfiler::Sense);
+    switch (Trigger.Kind)
+    {
+        case DriveTrigger::RangeBelow:
+        case DriveTrigger::Standoff:
+        {
+            if ((m_FrontDistance == 0) || !m_FrontDistance->ObjectDetected()) return false;
+            RangeMm = (ControlScalar)m_FrontDistance->ObjectDistanceMm();
+            return (Trigger.Kind == DriveTrigger::Standoff) || (RangeMm < (ControlScalar)Trigger.Range);
+        }
+        case DriveTrigger::Line:
+            return (m_FrontOptical != 0) && (m_FrontOptical->Brightness() >= Trigger.Low);
+        case DriveTrigger::Color:
+        {
+            if (m_FrontOptical == 0) return false;
+            double Hue = m_FrontOptical->Hue();
+            if (Trigger.Low <= Trigger.High) return (Hue >= Trigger.Low) && (Hue <= Trigger.High);
+            return (Hue >= Trigger.Low) || (Hue <= Trigger.High);
+        }
+    }
+    return false;
+}
+
+/// @brief DriveDistance body, entering and leaving at a speed when chained in a routine
+/// @param EntryRPM [RPM] motor speed the bot is already moving at in the direction of travel
+/// @param ExitRPM [RPM] motor speed to leave the segment at, 0 to come to rest
+/// @param StartOffset [mm] distance already covered, the overshoot of the previous chained segment
+/// @param StopAtEnd [bool] false leaves the motors to the next segment of a routine
+/// @param CancelCount [uint32_t] _cancelCount when the motion was started, a cancel changes it and stops the motion
+/// @param Curvature [1/mm][Optional] 0 drives straight, otherwise 1 / radius of an arc, positive curves clockwise
+/// @param Trigger [DriveTrigger*][Optional] sensor condition that replaces the rest of the drive with a brake, sets _triggerFired
+/// @return [mm] distance traveled past the end of the segment
+ControlScalar Min6AutoDrivetrain::DriveSegment(ControlScalar Distance, ControlScalar DriveVelocity, ControlScalar TimeOut, int AccertionSteps,
+                                        ControlScalar EntryRPM, ControlScalar ExitRPM, ControlScalar StartOffset, bool StopAtEnd,
+                                        uint32_t CancelCount, ControlScalar Curvature, const DriveTrigger *Trigger)
+{
+    if (Logging(LogLevels::CallsOnly))
+    {
+        printf("-----[DriveDistance]-----\n");
+        printf("Distance: %f\n", (double)Distance);
+        if (Curvature != 0) printf("Radius: %f\n", (double)(ControlScalar(1) / Curvature));
+        printf("DriveVelocity: %f\n", (double)DriveVelocity);
+        printf("TimeOut: %f\n", (double)TimeOut);
+        printf("-------------------------\n");
+    }
+
+    //Hold the heading and encoder positions the drive starts from
+    if (!BeginMotion()) return 0;
+    const DrivetrainSnapshot &start = m_IO.Sample();
+    ControlScalar StartRotation = start.Rotation;
+    _motionStartRotation = StartRotation;
+    _motionKind = TelemetryDrive;
+    m_IO.Pose().SetGeometry(_mmPerMotorDeg);
+    ControlScalar Boost = UpdateBatteryCompensation();
+    ControlScalar StartPosition = (start.LeftPosition + start.RightPosition) / ControlScalar(2);
+    ControlScalar Direction = (Distance < 0) ? ControlScalar(-1) : ControlScalar(1);
+
+    //Convert between motor RPM and wheel travel
+    ControlScalar mmPerMotorDeg = _mmPerMotorDeg;
+    ControlScalar rpmPerMmPerSec = _rpmPerMmPerSec;
+    ControlScalar Kv = (_driveKv > 0) ? _driveKv : rpmPerMmPerSec;
+    ControlScalar TickSec = _tickSec;
+
+    //On an arc the wheels run faster and slower than the center by ArcSpread of its speed, and the heading
+    //turns with the distance covered
+    ControlScalar ArcSpread = Curvature * _halfTrack;
+    ControlScalar CenterRPM = CurvatureRPM(DriveVelocity, Curvature);
+    ControlScalar DegPerMm = Curvature * ControlScalar(180 / M_PI);
+    ControlScalar TopRPM = _maxMotorRPM / (ControlScalar(1) + ScalarAbs(ArcSpread));
+
+    //Setup PID signal Calculaters: distance against the profile [RPM/mm] and heading hold [RPM/deg]
+    PIDController drivePid(_driveKp, _driveKi, _driveKd);
+    drivePid.setOutputLimits(-DriveVelocity, DriveVelocity);
+    drivePid.setIntegralLimit(DriveVelocity / 4);
+    drivePid.setDerivativeFilter(2 * _tickSec);
+    PIDController headingPid(_headingKp, _headingKi, _headingKd);
+    headingPid.setOutputLimits(-DriveVelocity / 2, DriveVelocity / 2);
+    headingPid.setIntegralLimit(DriveVelocity / 8);
+    headingPid.setDerivativeFilter(2 * _tickSec);
+
+    //Setup Acceration control: reach DriveVelocity after AccertionSteps control periods
+    ControlScalar accelerationTime = AccertionSteps * _tickSec;
+    if (accelerationTime <= 0) accelerationTime = _tickSec;
+    ControlScalar MaxAcceleration = (DriveVelocity / rpmPerMmPerSec) / accelerationTime;
+    ControlScalar MaxJerk = _driveJerk / rpmPerMmPerSec;
+    MotionProfile profile;
+    profile.Plan(Distance - StartOffset,
+                 CenterRPM / rpmPerMmPerSec,
+                 MaxAcceleration,
+                 MaxJerk,
+                 EntryRPM / rpmPerMmPerSec,
+                 ExitRPM / rpmPerMmPerSec);
+    if (Logging(LogLevels::Verbose)) printf("Profile Duration: %f\n", (double)profile.GET_Duration());
+
+    //A fired trigger replaces the profile with a brake, timed and positioned from the tick it fired on
+    ControlScalar ProfileStartSec = 0;
+    ControlScalar ProfileBase = StartOffset;
+    _triggerFired = false;
+
+    ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+    ControlScalar Traveled = StartOffset;
+    RunControlLoop(loop, CancelCount, TimeOut, [&](const DrivetrainSnapshot &sensors, bool onTime) -> bool
+    {
+        Traveled = StartOffset + (((sensors.LeftPosition + sensors.RightPosition) * ControlScalar(0.5)) - StartPosition) * mmPerMotorDeg;
+        if ((Traveled * Direction) >= ScalarAbs(Distance)) return false;
+
+        //Profile feedforward, one tick ahead, plus feedback on the tracking error, never backwards. The drive only ends past
+        //the distance, so a bot at rest short of it gets kS to break static friction unless it is slowing down with the profile.
+        ControlScalar Elapsed = loop.ElapsedSec();
+        ControlScalar ProfileTime = Elapsed - ProfileStartSec;
+        ProfileState setpoint = profile.Sample(ProfileTime);
+
+        //Poll the trigger every tick and brake from the setpoint speed once it fires. A standoff holds off until
+        //the stopping distance plus one tick of travel reaches the standoff point, then brakes onto it.
+        ControlScalar RangeMm = 0;
+        if ((Trigger != 0) && !_triggerFired && ReadTrigger(*Trigger, RangeMm))
+        {
+            ControlScalar Speed = ScalarAbs(setpoint.Velocity);
+            ControlScalar Brake = MotionProfile::StoppingDistance(Speed, MaxAcceleration, MaxJerk);
+            bool Fire = true;
+            if (Trigger->Kind == DriveTrigger::Standoff)
+            {
+                ControlScalar Remaining = RangeMm - (ControlScalar)Trigger->Range;
+                Fire = Remaining <= (Brake + (Speed * TickSec));
+                if (Remaining > Brake) Brake = Remaining;
+            }
+            if (Fire)
+            {
+                _triggerFired = true;
+                profile.Plan(Direction * Brake, CenterRPM / rpmPerMmPerSec, MaxAcceleration, MaxJerk, Speed, 0);
+                ProfileStartSec = Elapsed;
+                ProfileTime = 0;
+                ProfileBase = Traveled;
+                Distance = Traveled + (Direction * Brake);
+                setpoint = profile.Sample(ProfileTime);
+                if (Logging(LogLevels::Verbose)) printf("Trigger at %f mm, braking over %f mm\n", (double)Traveled, (double)Brake);
+            }
+        }
+        ProfileState ahead = profile.Sample(ProfileTime + TickSec);
+        setpoint.Position += ProfileBase;
+        ControlScalar Tracking = setpoint.Position - Traveled;
+        ControlScalar MotorVelocity = (ahead.Velocity * Kv)
+                             + (((ahead.Acceleration * _driveKa) + drivePid.calculateControlSignal(Tracking, loop.GET_LastDtSec())) * Boost);
+        bool AtRest = ScalarAbs(sensors.LeftRPM + sensors.RightRPM) < _driveKs;
+        if (AtRest && ((ProfileTime >= profile.GET_Duration()) || ((setpoint.Acceleration * Direction) >= 0))) MotorVelocity += Direction * _driveKs * Boost;
+        if ((MotorVelocity * Direction) < 0) MotorVelocity = 0;
+        if ((MotorVelocity * Direction) > TopRPM) MotorVelocity = Direction * TopRPM;
+
+        //Steer back to the heading for the distance covered, positive steering turns clockwise. The derivative is
+        //taken on the error so the turning of an arc target is not damped.
+        ControlScalar HeadingError = (StartRotation + (Traveled * DegPerMm)) - sensors.Rotation;
+        ControlScalar Steering = headingPid.calculateControlSignal(HeadingError, loop.GET_LastDtSec()) * Boost;
+        ControlScalar Bend = MotorVelocity * ArcSpread;
+        CommandMotors(MotorVelocity + Bend + Steering, MotorVelocity - Bend - Steering);
+
+        if (Logging(LogLevels::Verbose))
+            RecordTick(Distance, MotorVelocity, Elapsed, onTime);
+        return true;
+    });
+    if (StopAtEnd) m_IO.Stop();
+
+    if (Logging(LogLevels::CallsOnly)) 
+    {
+        const DrivetrainSnapshot &sensors = m_IO.Sample();
+        printf("Final Distance: %f mm\n", (double)(StartOffset + (((sensors.LeftPosition + sensors.RightPosition) * ControlScalar(0.5)) - StartPosition) * mmPerMotorDeg));
+        printf("Heading Drift: %f degress\n", (double)(sensors.Rotation - StartRotation));
+        if (Trigger != 0) printf("Trigger: %s\n", _triggerFired ? "fired" : "not fired");
+    }
+    LogMotionEnd(loop);
+    m_IO.End();
+
+    return (Traveled - Distance) * Direction;
+}
+
+/// @brief Run a routine table step by step. Consecutive drives and arcs in the same direction hand their speed
+/// to the next one instead of stopping and carry their overshoot into its distance.
+/// @param Routine [RoutineTable] steps to run
+void Min6AutoDrivetrain::RunRoutine(const RoutineTable &Routine)
+{
+    RoutineSegment(Routine, _cancelCount);
+}
+
+/// @brief RunRoutine body. Every step runs on the routine's CancelCount, so a cancel between steps stops the next one.
+/// @param CancelCount [uint32_t] _cancelCount when the routine was started, a cancel changes it and stops the routine
+void Min6AutoDrivetrain::RoutineSegment(const RoutineTable &Routine, uint32_t CancelCount)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("-----[RunRoutine %s]-----\n", Routine.Name);
+    double EntryRPM = 0;
+    double Carry = 0;
+    for (int i = 0; i < Routine.StepCount; i++)
+    {
+        if (_cancelCount != CancelCount) break;
+        const RoutineStep &step = Routine.Steps[i];
+        const RoutineStep *next = ((i + 1) < Routine.StepCount) ? &Routine.Steps[i + 1] : 0;
+        bool NextMoves = (next != 0) && ((next->Kind == RoutineStep::Turn) || (next->Kind == RoutineStep::Drive) || (next->Kind == RoutineStep::DriveUntil)
+                                         || (next->Kind == RoutineStep::Arc) || (next->Kind == RoutineStep::Path));
+        //A DriveUntil without its sensor only stops the motors, so the step before it must come to rest on its own
+        bool NextDrives = (next != 0) && ((next->Kind == RoutineStep::Drive) || (next->Kind == RoutineStep::Arc)
+                                          || ((next->Kind == RoutineStep::DriveUntil) && TriggerSensorAttached(next->Trigger)));
+        switch (step.Kind)
+        {
+            case RoutineStep::Turn:
+                TurnSegment(step.Value, step.Velocity, step.TimeOut, step.Tolerance, step.AccertionSteps, !NextMoves, CancelCount);
+                EntryRPM = 0;
+                Carry = 0;
+                break;
+            case RoutineStep::Drive:
+            case RoutineStep::Arc:
+            {
+                if ((step.Kind == RoutineStep::Arc) && ((step.Radius <= 0) || (step.Value == 0)))
+                {
+                    if (Logging(LogLevels::CallsOnly)) printf("Arc step: radius must be positive and angle not zero\n");
+                    m_IO.Stop();
+                    EntryRPM = 0;
+                    Carry = 0;
+                    break;
+                }
+                //Blend into a following drive or arc the same way at the lower of the two center speeds
+                double ExitRPM = 0;
+                double Distance = StepDistance(step);
+                if (NextDrives && ((StepDistance(*next) * Distance) > 0))
+                {
+                    double StepRPM = CurvatureRPM(step.Velocity, StepCurvature(step));
+                    double NextRPM = CurvatureRPM(next->Velocity, StepCurvature(*next));
+                    ExitRPM = (NextRPM < StepRPM) ? NextRPM : StepRPM;
+                }
+                double Overshoot = DriveSegment(Distance, step.Velocity, step.TimeOut, step.AccertionSteps,
+                                                EntryRPM, ExitRPM, Carry, ExitRPM <= 0, CancelCount, StepCurvature(step));
+                EntryRPM = ExitRPM;
+                Carry = (ExitRPM > 0) ? Overshoot * ((StepDistance(*next) < 0) ? -1.0 : 1.0) : 0;
+                break;
+            }
+            case RoutineStep::DriveUntil:
+            {
+                //Always comes to rest: the brake point is only known once the trigger fires
+                if (TriggerSensorAttached(step.Trigger))
+                    DriveSegment(step.Value, step.Velocity, step.TimeOut, step.AccertionSteps, EntryRPM, 0, Carry, true, CancelCount, 0, &step.Trigger);
+                else
+                    m_IO.Stop();
+                EntryRPM = 0;
+                Carry = 0;
+                break;
+            }
+            case RoutineStep::Path:
+            {
+                //Starts from wherever the bot is and always comes to rest
+                m_IO.Stop();
+                PathSegment(step.Points, step.PointCount, step.Velocity, step.Value, step.TimeOut, step.AccertionSteps, CancelCount);
+                EntryRPM = 0;
+                Carry = 0;
+                break;
+            }
+            case RoutineStep::Wait:
+            case RoutineStep::WaitUntil:
+            {
+                m_IO.Stop();
+                EntryRPM = 0;
+                Carry = 0;
+                m_Brain.ResetTimer();
+                while ((m_Brain.TimerSec() < step.TimeOut) && (_cancelCount == CancelCount))
+                {
+                    if ((step.Kind == RoutineStep::WaitUntil) && (step.Condition != 0) && step.Condition()) break;
+                    m_Brain.SleepMs(_controlPeriodMs);
+                }
+                break;
+            }
+        }
+    }
+    m_IO.Stop();
+    if (Logging(LogLevels::CallsOnly)) 
+        printf((_cancelCount != CancelCount) ? "Routine %s cancelled\n" : "Routine %s done\n", Routine.Name);
+}
+
+/// @brief Signed center travel of a Drive, DriveUntil or Arc step
+/// @return [mm] distance, arcs always drive forward
+double Min6AutoDrivetrain::StepDistance(const RoutineStep &Step)
+{
+    if (Step.Kind == RoutineStep::Arc) return Step.Radius * fabs(Step.Value) * (M_PI / 180.0);
+    return Step.Value;
+}
+
+/// @brief Curvature of a Drive, DriveUntil or Arc step
+/// @return [1/mm] 0 for straight steps, positive curves clockwise
+ControlScalar Min6AutoDrivetrain::StepCurvature(const RoutineStep &Step)
+{
+    if ((Step.Kind != RoutineStep::Arc) || (Step.Radius <= 0)) return 0;
+    return ((Step.Value < 0) ? ControlScalar(-1) : ControlScalar(1)) / (ControlScalar)Step.Radius;
+}
+
+/// @brief Tune the turn gains with a relay feedback experiment: the bot rocks about its heading under a
+/// bang-bang motor command, the oscillation gives the ultimate gain and period, and Rule turns those into gains.
+/// Valid gains are applied to TurnToHeading at once.
+/// @param RelayRPM [RPM] relay motor velocity, must move the bot
+/// @param Rule [TuneRules] response the gains are chosen for
+/// @param Hysteresis [deg][Optional default value is 0.5] relay switching band, above the gyro noise
+/// @param Cycles [int][Optional default value is 6] oscillation cycles averaged after the start up cycles
+/// @param TimeOut [sec][Optional default value is 10] time allotted to the experiment
+/// @return [AutoTuneResult] measured Ku, Pu and the gains
+AutoTuneResult Min6AutoDrivetrain::AutoTuneTurn(double RelayRPM, TuneRules Rule, double Hysteresis, int Cycles, double TimeOut)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("-----[AutoTuneTurn]-----\n");
+    AutoTuneResult result = RelayExperiment(false, RelayRPM, Hysteresis, Cycles, TimeOut);
+    ApplyTuneRule(result, Rule);
+    if (result.Valid) Set_TURN_PID(result.Kp, result.Ki, result.Kd);
+    return result;
+}
+
+/// @brief Tune the drive gains with a relay feedback experiment: the bot rocks back and forth about its
+/// start position holding its heading. Valid gains are applied to DriveDistance at once.
+/// @param RelayRPM [RPM] relay motor velocity, must move the bot
+/// @param Rule [TuneRules] response the gains are chosen for
+/// @param Hysteresis [mm][Optional default value is 2] relay switching band
+/// @param Cycles [int][Optional default value is 6] oscillation cycles averaged after the start up cycles
+/// @param TimeOut [sec][Optional default value is 10] time allotted to the experiment
+/// @return [AutoTuneResult] measured Ku, Pu and the gains
+AutoTuneResult Min6AutoDrivetrain::AutoTuneDrive(double RelayRPM, TuneRules Rule, double Hysteresis, int Cycles, double TimeOut)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("-----[AutoTuneDrive]-----\n");
+    AutoTuneResult result = RelayExperiment(true, RelayRPM, Hysteresis, Cycles, TimeOut);
+    ApplyTuneRule(result, Rule);
+    if (result.Valid) Set_DRIVE_PID(result.Kp, result.Ki, result.Kd);
+    return result;
+}
+
+/// @brief Relay with hysteresis around the starting rotation (turn) or position (drive), measuring the
+/// limit cycle it settles into. Ku = 4d / (pi * sqrt(a^2 - h^2)) for relay amplitude d, oscillation amplitude a
+/// and hysteresis h; Pu is the mean time between rising relay switches.
+AutoTuneResult Min6AutoDrivetrain::RelayExperiment(bool DriveAxis, ControlScalar RelayRPM, ControlScalar Hysteresis, int Cycles, ControlScalar TimeOut)
+{
+    AutoTuneResult result = {false, 0, 0, 0, 0, 0, 0};
+    uint32_t CancelCount = _cancelCount;
+    RelayRPM = ScalarAbs(RelayRPM);
+    Hysteresis = ScalarAbs(Hysteresis);
+
+    if (!BeginMotion()) return result;
+    const DrivetrainSnapshot &start = m_IO.Sample();
+    ControlScalar StartRotation = start.Rotation;
+    ControlScalar StartPosition = (start.LeftPosition + start.RightPosition) / ControlScalar(2);
+    ControlScalar mmPerMotorDeg = _mmPerMotorDeg;
+    _motionStartRotation = StartRotation;
+    _motionKind = 0;
+    m_IO.Pose().SetGeometry(mmPerMotorDeg);
+
+    //Heading hold while the drive axis rocks
+    PIDController headingPid(_headingKp, _headingKi, _headingKd);
+    headingPid.setOutputLimits(-RelayRPM / 2, RelayRPM / 2);
+
+    //The first cycles are the bot leaving rest, they are not measured
+    const int StartUpCycles = 2;
+    ControlScalar Output = RelayRPM;
+    ControlScalar LastRiseSec = -1;
+    ControlScalar CycleMax = 0;
+    ControlScalar CycleMin = 0;
+    ControlScalar PeriodSum = 0;
+    ControlScalar AmplitudeSum = 0;
+    int CycleCount = 0;
+    int Measured = 0;
+
+    ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+    RunControlLoop(loop, CancelCount, TimeOut, [&](const DrivetrainSnapshot &sensors, bool onTime) -> bool
+    {
+        if (Measured >= Cycles) return false;
+        ControlScalar Measurement = DriveAxis
+                           ? (((sensors.LeftPosition + sensors.RightPosition) * ControlScalar(0.5)) - StartPosition) * mmPerMotorDeg
+                           : sensors.Rotation - StartRotation;
+        if (Measurement > CycleMax) CycleMax = Measurement;
+        if (Measurement < CycleMin) CycleMin = Measurement;
+
+        //Relay with hysteresis on the error from the start, a rising switch closes a cycle
+        ControlScalar Error = -Measurement;
+        if ((Error > Hysteresis) && (Output < 0))
+        {
+            Output = RelayRPM;
+            ControlScalar Now = loop.ElapsedSec();
+            if (LastRiseSec >= 0)
+            {
+                CycleCount++;
+                if (CycleCount > StartUpCycles)
+                {
+                    PeriodSum += Now - LastRiseSec;
+                    AmplitudeSum += (CycleMax - CycleMin) / ControlScalar(2);
+                    Measured++;
+                }
+            }
+            LastRiseSec = Now;
+            CycleMax = Measurement;
+            CycleMin = Measurement;
+        }
+        else if ((Error < -Hysteresis) && (Output > 0))
+        {
+            Output = -RelayRPM;
+        }
+
+        if (DriveAxis)
+        {
+            ControlScalar Steering = headingPid.calculateControlSignal(StartRotation - sensors.Rotation, sensors.Rotation, loop.GET_LastDtSec());
+            CommandMotors(Output + Steering, Output - Steering);
+        }
+        else
+            CommandMotors(Output, Output * -1);
+
+        if (Logging(LogLevels::Verbose))
+            RecordTick(0, Output, loop.ElapsedSec(), onTime);
+        return true;
+    });
+    m_IO.Stop();
+
+    if (Measured >= Cycles)
+    {
+        result.Amplitude = (double)AmplitudeSum / Measured;
+        result.UltimatePeriod = (double)PeriodSum / Measured;
+        double band = (double)Hysteresis;
+        if (result.Amplitude > band)
+        {
+            result.UltimateGain = (4.0 * (double)RelayRPM) / (M_PI * sqrt((result.Amplitude * result.Amplitude) - (band * band)));
+            result.Valid = true;
+        }
+    }
+    if (Logging(LogLevels::CallsOnly))
+    {
+        if (result.Valid)
+            printf("Ku: %f, Pu: %fs, Amplitude: %f\n", result.UltimateGain, result.UltimatePeriod, result.Amplitude);
+        else
+            printf("No steady oscillation after %d cycles\n", Measured);
+    }
+    LogMotionEnd(loop);
+    m_IO.End();
+
+    return result;
+}
+
+/// @brief Gains from the ultimate gain and period. Both axes integrate motor velocity into position and the
+/// motion profile already supplies the velocity, so the integral term would only wind up on the profile lag:
+/// the rules keep the Ziegler-Nichols proportional and derivative terms and leave Ki at 0.
+/// @param Result [AutoTuneResult] measured Ku and Pu, Kp/Ki/Kd are filled in
+/// @param Rule [TuneRules] Fast: Kp 0.6Ku, Td Pu/8. NoOvershoot: Kp 0.2Ku, Td Pu/3
+void Min6AutoDrivetrain::ApplyTuneRule(AutoTuneResult &Result, TuneRules Rule)
+{
+    if (!Result.Valid) return;
+    double Ku = Result.UltimateGain;
+    double Pu = Result.UltimatePeriod;
+    if (Rule == TuneRules::Fast)
+    {
+        Result.Kp = 0.6 * Ku;
+        Result.Kd = Result.Kp * (Pu / 8.0);
+    }
+    else
+    {
+        Result.Kp = 0.2 * Ku;
+        Result.Kd = Result.Kp * (Pu / 3.0);
+    }
+    Result.Ki = 0;
+    if (Logging(LogLevels::CallsOnly))
+        printf("Gains: Kp %f, Ki %f, Kd %f\n", Result.Kp, Result.Ki, Result.Kd);
+}
+
+/// @brief Measure the turn feedforward: the bot pivots on a slow ramp, coasts, then steps the other way.
+/// Valid constants are applied to TurnToHeading at once.
+/// @param MaxRPM [RPM][Optional default value is 60] top of the ramp and size of the step
+/// @param RampRPMPerSec [RPM/sec][Optional default value is 20] ramp rate, slow enough to be quasi-static
+/// @param TimeOut [sec][Optional default value is 10] time allotted to the experiment
+/// @return [FeedforwardResult] kS, kV and kA
+FeedforwardResult Min6AutoDrivetrain::CharacterizeTurn(double MaxRPM, double RampRPMPerSec, double TimeOut)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("-----[CharacterizeTurn]-----\n");
+    FeedforwardResult result = FeedforwardExperiment(false, MaxRPM, RampRPMPerSec, TimeOut);
+    if (result.Valid) Set_TURN_FEEDFORWARD(result.Ks, result.Kv, result.Ka);
+    return result;
+}
+
+/// @brief Measure the drive feedforward: the bot drives forward on a slow ramp, coasts, then steps back,
+/// holding its heading. It needs about a metre of clear floor ahead at the defaults.
+/// Valid constants are applied to DriveDistance at once.
+/// @param MaxRPM [RPM][Optional default value is 60] top of the ramp and size of the step
+/// @param RampRPMPerSec [RPM/sec][Optional default value is 20] ramp rate, slow enough to be quasi-static
+/// @param TimeOut [sec][Optional default value is 10] time allotted to the experiment
+/// @return [FeedforwardResult] kS, kV and kA
+FeedforwardResult Min6AutoDrivetrain::CharacterizeDrive(double MaxRPM, double RampRPMPerSec, double TimeOut)
+{
+    if (Logging(LogLevels::CallsOnly)) printf("-----[CharacterizeDrive]-----\n");
+    FeedforwardResult result = FeedforwardExperiment(true, MaxRPM, RampRPMPerSec, TimeOut);
+    if (result.Valid) Set_DRIVE_FEEDFORWARD(result.Ks, result.Kv, result.Ka);
+    return result;
+}
+
+/// @brief Ramp, coast and reverse step on one axis. kS is the ramp command at which the bot first moves;
+/// kV and kA are the least squares fit of command = kV*v + kA*a over the moving samples, with v and a
+/// from central differences of the rotation (turn) or mean encoder travel (drive) over five ticks.
+FeedforwardResult Min6AutoDrivetrain::FeedforwardExperiment(bool DriveAxis, ControlScalar MaxRPM, ControlScalar RampRPMPerSec, ControlScalar TimeOut)
+{
+    FeedforwardResult result = {false, 0, 0, 0, 0};
+    uint32_t CancelCount = _cancelCount;
+    MaxRPM = ScalarAbs(MaxRPM);
+    RampRPMPerSec = ScalarAbs(RampRPMPerSec);
+    if ((MaxRPM <= 0) || (RampRPMPerSec <= 0)) return result;
+
+    if (!BeginMotion()) return result;
+    const DrivetrainSnapshot &start = m_IO.Sample();
+    ControlScalar StartRotation = start.Rotation;
+    ControlScalar StartPosition = (start.LeftPosition + start.RightPosition) / ControlScalar(2);
+    ControlScalar mmPerMotorDeg = _mmPerMotorDeg;
+    _motionStartRotation = StartRotation;
+    _motionKind = 0;
+    m_IO.Pose().SetGeometry(mmPerMotorDeg);
+
+    //Heading hold while the drive axis runs
+    PIDController headingPid(_headingKp, _headingKi, _headingKd);
+    headingPid.setOutputLimits(-MaxRPM / 2, MaxRPM / 2);
+
+    //Phases: ramp up to MaxRPM, coast to rest, step to -MaxRPM
+    const ControlScalar CoastSec = ControlScalar(0.75);
+    const ControlScalar StepSec = ControlScalar(1);
+    const double MovingSpeed = 10.0;    //[deg/sec] or [mm/sec] slower than this counts as at rest
+    ControlScalar RampSec = MaxRPM / RampRPMPerSec;
+    ControlScalar EndSec = RampSec + CoastSec + StepSec;
+
+    //Last five measurements and commands, the fit uses the middle one. The fit sums are kept in double.
+    const int Window = 5;
+    double Measurements[Window];
+    double Commands[Window];
+    const double VelocityScale = 0.5 * (double)_tickRate;                         //Central differences over 2 and 4 ticks
+    const double AccelerationScale = 0.25 * (double)_tickRate * (double)_tickRate;
+    int Filled = 0;
+    double Svv = 0, Sva = 0, Saa = 0, Scv = 0, Sca = 0;
+
+    ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+    RunControlLoop(loop, CancelCount, TimeOut, [&](const DrivetrainSnapshot &sensors, bool onTime) -> bool
+    {
+        ControlScalar Elapsed = loop.ElapsedSec();
+        if (Elapsed >= EndSec) return false;
+
+        ControlScalar Output = 0;
+        if (Elapsed < RampSec) Output = RampRPMPerSec * Elapsed;
+        else if (Elapsed >= (RampSec + CoastSec)) Output = -MaxRPM;
+
+        //Central differences about the middle of the window, pairing the command sent at that tick
+        for (int i = 0; i < (Window - 1); i++)
+        {
+            Measurements[i] = Measurements[i + 1];
+            Commands[i] = Commands[i + 1];
+        }
+        Measurements[Window - 1] = (double)(DriveAxis
+                                 ? (((sensors.LeftPosition + sensors.RightPosition) * ControlScalar(0.5)) - StartPosition) * mmPerMotorDeg
+                                 : sensors.Rotation - StartRotation);
+        Commands[Window - 1] = (double)Output;
+        if (Filled < Window) Filled++;
+        if ((Filled == Window) && onTime)
+        {
+            double Velocity = (Measurements[3] - Measurements[1]) * VelocityScale;
+            double Acceleration = (Measurements[4] - (2.0 * Measurements[2]) + Measurements[0]) * AccelerationScale;
+            double Command = Commands[2];
+            if (fabs(Velocity) >= MovingSpeed)
+            {
+                if ((result.Ks == 0) && (Command > 0)) result.Ks = Command;
+                Svv += Velocity * Velocity;
+                Sva += Velocity * Acceleration;
+                Saa += Acceleration * Acceleration;
+                Scv += Command * Velocity;
+                Sca += Command * Acceleration;
+                result.Samples++;
+            }
+        }
+
+        if (DriveAxis)
+        {
+            ControlScalar Steering = headingPid.calculateControlSignal(StartRotation - sensors.Rotation, sensors.Rotation, loop.GET_LastDtSec());
+            CommandMotors(Output + Steering, Output - Steering);
+        }
+        else
+            CommandMotors(Output, Output * -1);
+
+        if (Logging(LogLevels::Verbose))
+            RecordTick(0, Output, Elapsed, onTime);
+        return true;
+    });
+    m_IO.Stop();
+
+    //Normal equations of the two parameter fit
+    const int MinimumSamples = 20;
+    double Determinant = (Svv * Saa) - (Sva * Sva);
+    if ((result.Samples >= MinimumSamples) && (result.Ks > 0) && (Determinant > 0))
+    {
+        result.Kv = ((Scv * Saa) - (Sca * Sva)) / Determinant;
+        result.Ka = ((Sca * Svv) - (Scv * Sva)) / Determinant;
+        result.Valid = (result.Kv > 0) && (result.Ka >= 0);
+    }
+    if (Logging(LogLevels::CallsOnly))
+    {
+        if (result.Valid)
+            printf("kS: %f, kV: %f, kA: %f from %d samples\n", result.Ks, result.Kv, result.Ka, result.Samples);
+        else
+            printf("No feedforward fit from %d moving samples\n", result.Samples);
+    }
+    LogMotionEnd(loop);
+    m_IO.End();
+
+    return result;
+}
+
+/// @brief Common end of motion reporting: timing, loop statistics and the post-run telemetry dump.
+/// @param loop [ControlLoopTimer] the loop that paced the motion
+void Min6AutoDrivetrain::LogMotionEnd(ControlLoopTimer &loop)
+{
+    if (Logging(LogLevels::CallsOnly)) 
+    {
+        printf("Time To Complete: %fs\n", m_Brain.TimerSec());
+        printf("Loop: %d ticks, %d overruns, jitter mean %luus max %luus\n",
+            loop.GET_TickCount(),
+            loop.GET_OverrunCount(),
+            (unsigned long)loop.GET_MeanJitterUs(),
+            (unsigned long)loop.GET_MaxJitterUs());
+        printf("Motor writes skipped: %d\n", m_IO.GET_SkippedWrites());
+    }
+    //Without a drain task the ticks are written out once the bot has stopped
+    if ((Logging(LogLevels::Verbose)) && !_telemetryTask.IsStarted()) DumpTelemetry();
+}
+
+/// @brief Sample the battery and work out the command scale for the motion about to start
+/// @return [ControlScalar] nominal / measured voltage, measured clamped to the floor, 1 when compensation is off or the voltage is unknown
+ControlScalar Min6AutoDrivetrain::UpdateBatteryCompensation()
+{
+    _batteryVolts = (ControlScalar)m_Brain.BatteryVoltage();
+    ControlScalar Volts = (_batteryVolts > _batteryFloorVolts) ? _batteryVolts : _batteryFloorVolts;
+    _batteryCompensation = ((_batteryNominalVolts > 0) && (Volts > 0)) ? (_batteryNominalVolts / Volts) : ControlScalar(1);
+    if (Logging(LogLevels::Verbose))
+        printf("Battery: %f V, compensation %f\n", (double)_batteryVolts, (double)_batteryCompensation);
+    return _batteryCompensation;
+}
+
+/// @brief Highest center motor RPM on a curvature: the outer wheel stays inside DriveVelocity and the sideways
+/// acceleration inside Set_MAX_LATERAL_ACCELERATION
+/// @param DriveVelocity [RPM] top wheel RPM
+/// @param Curvature [1/mm] 1 / radius, 0 for straight
+/// @return [RPM] center motor RPM
+ControlScalar Min6AutoDrivetrain::CurvatureRPM(ControlScalar DriveVelocity, ControlScalar Curvature)
+{
+    ControlScalar curvature = ScalarAbs(Curvature);
+    ControlScalar rpm = DriveVelocity / (ControlScalar(1) + (curvature * _halfTrack));
+    if ((_maxLateralAcceleration > 0) && (curvature > 0))
+    {
+        ControlScalar lateral = ScalarSqrt(_maxLateralAcceleration / curvature) * _rpmPerMmPerSec;
+        if (lateral < rpm) rpm = lateral;
+    }
+    return rpm;
+}
+
+/// @brief Work out the unit conversions again after a Set_ function changed the geometry or control period.
+/// Same arithmetic as DrivetrainConfig, which does it at compile time for the constructor.
+void Min6AutoDrivetrain::UpdateConversions()
+{
+    DrivetrainConfig config(_inGearSize, _outGearSize, (double)_wheelCircumference, (double)_trackWidth, (double)_maxMotorRPM, 0, _controlPeriodMs);
+    _mmPerMotorDeg = (ControlScalar)config.MmPerMotorDeg();
+    _rpmPerMmPerSec = (ControlScalar)config.RPMPerMmPerSec();
+    _turnRPMPerDegPerSec = (ControlScalar)config.TurnRPMPerDegPerSec();
+    _halfTrack = (ControlScalar)(config.TrackWidth / 2.0);
+    _tickSec = (ControlScalar)config.TickSec();
+    _tickRate = (ControlScalar)(1.0 / config.TickSec());
+}
+
+/// @brief Take over the drivetrain for a motion. Refused while another motion has it, such as a synchronous call on one
+/// task while an async motion runs on the drivetrain task: two loops would sample and command the motors together.
+/// @return [bool] false if the motion must return without touching the drivetrain
+bool Min6AutoDrivetrain::BeginMotion()
+{
+    if (m_IO.Begin()) return true;
+    if (Logging(LogLevels::CallsOnly)) printf("**BUSY** another motion is running\n");
+    return false;
+}
+
+/// @brief Sample the drivetrain sensors, timed as the Sense phase of the loop profiler
+const DrivetrainSnapshot &Min6AutoDrivetrain::SampleSensors()
+{
+    LoopPhaseTimer timer(m_Profiler, LoopProfiler::Sense);
+    return m_IO.Sample();
+}
+
+/// @brief Command both motors, timed as the Actuate phase of the loop profiler
+void Min6AutoDrivetrain::CommandMotors(ControlScalar LeftRPM, ControlScalar RightRPM)
+{
+    LoopPhaseTimer timer(m_Profiler, LoopProfiler::Actuate);
+    m_IO.Command(LeftRPM, RightRPM);
+}
+
+/// @brief Store one control tick in the telemetry ring from the current snapshot. Costs a few stores, no formatting or device reads.
+/// @param Target [deg] requested heading
+/// @param CommandRPM [RPM] requested motor velocity
+/// @param ElapsedSec [sec] time since the motion started
+/// @param OnTime [bool] false if the tick started after its deadline
+void Min6AutoDrivetrain::RecordTick(ControlScalar Target, ControlScalar CommandRPM, ControlScalar ElapsedSec, bool OnTime)
+{
+    LoopPhaseTimer timer(m_Profiler, LoopProfiler::Log);
+    const DrivetrainSnapshot &sensors = m_IO.Snapshot();
+    TelemetryRecord record;
+    record.TimeUs = (uint32_t)(ElapsedSec * ControlScalar(1000000));
+    record.Motion = _motionCount;
+    record.Flags = (OnTime ? 0 : TelemetryOverrun) | _motionKind;
+    record.Target = (float)Target;
+    record.CommandRPM = (float)CommandRPM;
+    record.RightRPM = (float)sensors.RightRPM;
+    record.LeftRPM = (float)sensors.LeftRPM;
+    record.Heading = (float)sensors.Heading;
+    record.Rotation = (float)(sensors.Rotation - _motionStartRotation);
+    _telemetry.Push(record);
+}
+
+/// @brief Write all queued telemetry records to the console as CSV.
+/// Only one reader may drain the ring: call this directly only when the telemetry task is not running.
+void Min6AutoDrivetrain::DumpTelemetry()
+{
+    TelemetryRecord record;
+    while (_telemetry.Pop(record))
+    {
+        if (record.Motion != _dumpedMotion)
+        {
+            _dumpedMotion = record.Motion;
+            const char *kind = (record.Flags & TelemetryTurn) ? "Turn" : ((record.Flags & TelemetryDrive) ? "Drive" : "Other");
+            printf("Telemetry Motion %u, Target %f, Kind %s\n", (unsigned int)record.Motion, (double)record.Target, kind);
+            printf("Time, Requested, Right Actual, Left Actual, Heading, Rotation, Overrun\n");
+        }
+        printf("%f, %f, %f, %f, %f, %f, %d\n",
+            record.TimeUs / 1000000.0,
+            (double)record.CommandRPM,
+            (double)record.RightRPM,
+            (double)record.LeftRPM,
+            (double)record.Heading,
+            (double)record.Rotation,
+            (record.Flags & TelemetryOverrun) ? 1 : 0);
+    }
+    int dropped = _telemetry.GET_Dropped();
+    if (dropped != _dumpedDropped)
+    {
+        printf("Telemetry dropped %d records\n", dropped - _dumpedDropped);
+        _dumpedDropped = dropped;
+    }
+}
+
+/// @brief Body of the telemetry task: drain the ring at a low rate for the life of the program
+static int TelemetryTaskEntry(void *Arg)
+{
+    Min6AutoDrivetrain *drivetrain = (Min6AutoDrivetrain *)Arg;
+    while (true)
+    {
+        drivetrain->DumpTelemetry();
+        PlatformSleepMs(50);
+    }
+    return 0;
+}
+
+/// @brief Start a low priority task that writes Verbose telemetry to the console while motions run.
+void Min6AutoDrivetrain::StartTelemetryTask()
+{
+    _telemetryTask.Start(TelemetryTaskEntry, this, PlatformTask::Low);
+}
+
+/// @brief Body of the odometry task: keep the pose current at the control rate while no motion is sampling
+static int OdometryTaskEntry(void *Arg)
+{
+    Min6AutoDrivetrain *drivetrain = (Min6AutoDrivetrain *)Arg;
+    drivetrain->UpdatePoseIdle();
+    return 0;
+}
+
+/// @brief Start a background task that updates the pose between motions. During a motion the control loop updates it.
+void Min6AutoDrivetrain::StartOdometryTask()
+{
+    m_IO.Pose().SetGeometry(_mmPerMotorDeg);
+    _odometryTask.Start(OdometryTaskEntry, this, PlatformTask::High);
+}
+
+/// @brief Odometry task loop, sampling the drivetrain whenever no motion is running
+void Min6AutoDrivetrain::UpdatePoseIdle()
+{
+    ControlLoopTimer loop(m_Brain, _controlPeriodMs * 1000);
+    loop.Start();
+    while (true)
+    {
+        m_IO.SampleIfIdle();
+        loop.WaitForNextTick();
+    }
+}
+
+/// @brief Latest pose estimate, safe to call from any task
+/// @return [Pose] field position in mm and heading in degrees
+Pose Min6AutoDrivetrain::GetPose()
+{
+    return m_IO.Pose().Get();
+}
+
+/// @brief Place the bot on the field. Takes effect on the next sample; the heading keeps following the inertial sensor.
+/// @param X [mm] field position
+/// @param Y [mm] field position
+void Min6AutoDrivetrain::ResetPose(double X, double Y)
+{
+    m_IO.Pose().SetGeometry(_mmPerMotorDeg);
+    m_IO.Pose().Reset(X, Y);
+}
+
+/// @brief Start the drivetrain task that runs queued async motions. Called on the first async motion if not called before.
+void Min6AutoDrivetrain::StartMotionTask()
+{
+    _motionTask.Start(MotionTaskEntry, this, PlatformTask::High);
+}
+
+/// @brief Body of the drivetrain task: run queued motions one at a time, in order
+int Min6AutoDrivetrain::MotionTaskEntry(void *Arg)
+{
+    Min6AutoDrivetrain *drivetrain = (Min6AutoDrivetrain *)Arg;
+    while (true)
+    {
+        drivetrain->_motionLock.Lock();
+        bool HaveCommand = (drivetrain->_motionQueueCount > 0);
+        MotionCommand command;
+        uint32_t CancelCount = 0;
+        if (HaveCommand)
+        {
+            command = drivetrain->_motionQueue[drivetrain->_motionQueueHead];
+            drivetrain->_motionQueueHead = (drivetrain->_motionQueueHead + 1) % MotionQueueCapacity;
+            drivetrain->_motionQueueCount--;
+            drivetrain->_runningMotionId = command.Id;
+            //Snapshot under the lock that makes this the running motion: a cancel from here on changes the count
+            CancelCount = drivetrain->_cancelCount;
+        }
+        drivetrain->_motionLock.Unlock();
+
+        if (!HaveCommand)
+        {
+            PlatformSleepMs(5);
+            continue;
+        }
+        if (!command.Cancelled)
+        {
+            if (command.Kind == MotionCommand::Turn)
+                drivetrain->TurnSegment(command.Target, command.Velocity, command.TimeOut, command.Tolerance, command.AccertionSteps, true, CancelCount);
+            else if (command.Kind == MotionCommand::Drive)
+                drivetrain->DriveSegment(command.Target, command.Velocity, command.TimeOut, command.AccertionSteps, 0, 0, 0, true, CancelCount);
+            else if (command.Kind == MotionCommand::DriveUntil)
+            {
+                if (drivetrain->TriggerSensorAttached(command.Trigger))
+                    drivetrain->DriveSegment(command.Target, command.Velocity, command.TimeOut, command.AccertionSteps, 0, 0, 0, true, CancelCount, 0, &command.Trigger);
+            }
+            else if (command.Kind == MotionCommand::Arc)
+                drivetrain->ArcSegment(command.Radius, command.Target, command.Velocity, command.TimeOut, command.AccertionSteps, CancelCount);
+            else if (command.Kind == MotionCommand::Path)
+                drivetrain->PathSegment(command.Points, command.PointCount, command.Velocity, command.Target, command.TimeOut, command.AccertionSteps, CancelCount);
+            else
+                drivetrain->RoutineSegment(*command.Table, CancelCount);
+        }
+
+        drivetrain->_motionLock.Lock();
+        drivetrain->_runningMotionId = 0;
+        drivetrain->_completedMotionId = command.Id;
+        drivetrain->_motionLock.Unlock();
+    }
+    return 0;
+}
+
+/// @brief Add a motion to the drivetrain task queue, waiting for room if it is full
+/// @param Command [MotionCommand] motion to run, its Id is assigned here
+/// @return [MotionHandle] handle to the queued motion
+MotionHandle Min6AutoDrivetrain::QueueMotion(MotionCommand &Command)
+{
+    if (!_motionTask.IsStarted()) StartMotionTask();
+    while (true)
+    {
+        _motionLock.Lock();
+        if (_motionQueueCount < MotionQueueCapacity)
+        {
+            Command.Id = _nextMotionId++;
+            Command.Cancelled = false;
+            _motionQueue[(_motionQueueHead + _motionQueueCount) % MotionQueueCapacity] = Command;
+            _motionQueueCount++;
+            _motionLock.Unlock();
+            return MotionHandle(this, Command.Id);
+        }
+        _motionLock.Unlock();
+        PlatformSleepMs(5);
+    }
+}
+
+/// @brief TurnToHeading on the drivetrain task. Returns at once; the turn runs after any motion queued before it.
+/// @return [MotionHandle] handle to wait for or cancel the turn
+MotionHandle Min6AutoDrivetrain::TurnToHeadingAsync(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::Turn;
+    command.Target = Heading;
+    command.Velocity = TurnVelocity;
+    command.TimeOut = TimeOut;
+    command.Tolerance = HeadingTolerance;
+    command.AccertionSteps = AccertionSteps;
+    command.Table = 0;
+    return QueueMotion(command);
+}
+
+/// @brief DriveDistance on the drivetrain task. Returns at once; the drive runs after any motion queued before it.
+/// @return [MotionHandle] handle to wait for or cancel the drive
+MotionHandle Min6AutoDrivetrain::DriveDistanceAsync(double Distance, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::Drive;
+    command.Target = Distance;
+    command.Velocity = DriveVelocity;
+    command.TimeOut = TimeOut;
+    command.Tolerance = 0;
+    command.AccertionSteps = AccertionSteps;
+    command.Table = 0;
+    return QueueMotion(command);
+}
+
+/// @brief DriveUntil on the drivetrain task. Returns at once; the drive runs after any motion queued before it.
+/// @return [MotionHandle] handle to wait for or cancel the drive
+MotionHandle Min6AutoDrivetrain::DriveUntilAsync(const DriveTrigger &Trigger, double MaxDistance, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::DriveUntil;
+    command.Target = MaxDistance;
+    command.Velocity = DriveVelocity;
+    command.TimeOut = TimeOut;
+    command.Tolerance = 0;
+    command.AccertionSteps = AccertionSteps;
+    command.Table = 0;
+    command.Trigger = Trigger;
+    return QueueMotion(command);
+}
+
+/// @brief ArcTurn on the drivetrain task. Returns at once; the arc runs after any motion queued before it.
+/// @return [MotionHandle] handle to wait for or cancel the arc
+MotionHandle Min6AutoDrivetrain::ArcTurnAsync(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::Arc;
+    command.Target = Angle;
+    command.Velocity = DriveVelocity;
+    command.TimeOut = TimeOut;
+    command.Tolerance = 0;
+    command.AccertionSteps = AccertionSteps;
+    command.Table = 0;
+    command.Radius = Radius;
+    return QueueMotion(command);
+}
+
+/// @brief FollowPath on the drivetrain task. The points must outlive the motion.
+/// @return [MotionHandle] handle to wait for or cancel the path
+MotionHandle Min6AutoDrivetrain::FollowPathAsync(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::Path;
+    command.Target = Lookahead;
+    command.Velocity = DriveVelocity;
+    command.TimeOut = TimeOut;
+    command.Tolerance = 0;
+    command.AccertionSteps = AccertionSteps;
+    command.Table = 0;
+    command.Points = Points;
+    command.PointCount = Count;
+    return QueueMotion(command);
+}
+
+/// @brief RunRoutine on the drivetrain task. The table must outlive the routine.
+/// @return [MotionHandle] handle to wait for or cancel the whole routine
+MotionHandle Min6AutoDrivetrain::RunRoutineAsync(const RoutineTable &Routine)
+{
+    MotionCommand command;
+    command.Kind = MotionCommand::Routine;
+    command.Target = 0;
+    command.Velocity = 0;
+    command.TimeOut = 0;
+    command.Tolerance = 0;
+    command.AccertionSteps = 0;
+    command.Table = &Routine;
+    return QueueMotion(command);
+}
+
+/// @brief Has an async motion finished. Motions complete in the order they were queued.
+/// @param Id [uint32_t] motion id from its handle
+/// @return [bool] true once the motion has run, timed out or been cancelled
+bool Min6AutoDrivetrain::IsMotionDone(uint32_t Id)
+{
+    return _completedMotionId >= Id;
+}
+
+/// @brief Cancel one async motion: skipped if still queued, stopped within a control tick if running
+/// @param Id [uint32_t] motion id from its handle
+void Min6AutoDrivetrain::CancelMotion(uint32_t Id)
+{
+    _motionLock.Lock();
+    if (Id == _runningMotionId) _cancelCount++;
+    for (int i = 0; i < _motionQueueCount; i++)
+    {
+        MotionCommand &command = _motionQueue[(_motionQueueHead + i) % MotionQueueCapacity];
+        if (command.Id == Id) command.Cancelled = true;
+    }
+    _motionLock.Unlock();
+}
+
+/// @brief Cancel every queued motion and stop the running one, async or not, within a control tick
+void Min6AutoDrivetrain::CancelAllMotion()
+{
+    _motionLock.Lock();
+    for (int i = 0; i < _motionQueueCount; i++)
+        _motionQueue[(_motionQueueHead + i) % MotionQueueCapacity].Cancelled = true;
+    _cancelCount++;
+    _motionLock.Unlock();
+}
+
+bool MotionHandle::isDone()
+{
+    return (m_Drivetrain == 0) || m_Drivetrain->IsMotionDone(_id);
+}
+
+void MotionHandle::wait()
+{
+    while (!isDone()) PlatformSleepMs(5);
+}
+
+void MotionHandle::cancel()
+{
+    if (m_Drivetrain != 0) m_Drivetrain->CancelMotion(_id);
+}
+
+/// @brief Signed shortest angle from one heading to another.
+/// @param Target [deg] heading to turn to
+/// @param Current [deg] heading turning from
+/// @return [deg] turn in the range (-180, 180], positive is clockwise
+ControlScalar Min6AutoDrivetrain::HeadingError(ControlScalar Target, ControlScalar Current)
+{
+    ControlScalar Error = ScalarFmod(Target - Current, ControlScalar(360));
+    if (Error > ControlScalar(180)) Error -= ControlScalar(360);
+    if (Error <= ControlScalar(-180)) Error += ControlScalar(360);
+    return Error;
 }
\ No newline at end of file
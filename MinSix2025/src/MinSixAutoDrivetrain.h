@@ -1,100 +1,559 @@
-/*----------------------------------------------------------------------------*/
-/*                                                                            */
-/*    Module:       MinSixAutoDrivetrain.h                                    */
-/*    Author:       Raiford G. Bonnell                                        */
-/*    Created:      3/28/2025, 7:51:13 PM                                     */
-/*    Description:  Drivetrain library for 6 wheel IQ drivetrain              */
-/*                                                                            */
-/*----------------------------------------------------------------------------*/
-
-#include <math.h> 
-#include "vex.h"
-
-#ifndef MinSixAutoDrivetrain
-#define MinSixAutoDrivetrain
-class Min6AutoDrivetrain
-{
-    private:
-        vex::brain m_Brain;
-        vex::inertial m_BrainInertial;
-        vex::motor m_RightDriveMotor;
-        vex::motor m_LeftDriveMotor;
-        
-        int _inGearSize;
-        int _outGearSize;
-        double _wheelCircumference;
-        double _maxMotorRPM;
-        double _minMotorRPM;
-
-        int GetQuad(double Heading);
-
-    public:    
-        enum LogLevels
-        {
-            None,
-            CallsOnly,
-            Verbose
-        };
-        LogLevels _logLevel;
-
-        /// @brief 
-        /// @param Brain 
-        /// @param BrainInertial 
-        /// @param RightDriveMotoer 
-        /// @param LeftDriveMotor 
-        Min6AutoDrivetrain(const vex::brain &Brain, 
-                           const vex::inertial &BrainInertial,
-                           const vex::motor &RightDriveMotoer, 
-                           const vex::motor &LeftDriveMotor) 
-                        : m_Brain(Brain)
-                        , m_BrainInertial(BrainInertial)
-                        , m_RightDriveMotor(RightDriveMotoer)
-                        , m_LeftDriveMotor(LeftDriveMotor)
-        {}
-
-        /// @brief Set the output log level
-        /// @param logLevel [LogLevels enum] log level value
-        void Set_LogLevel(LogLevels logLevel)
-        {
-            _logLevel = logLevel;
-        }
-
-        /// @brief Smallest motor velocity in RPMs which will result in bot motion
-        /// @param minimalVelocity [double] - minimal velocity value
-        void Set_MINIMAL_MOTOR_RPM(double minMotorRPM)
-        {
-            _minMotorRPM = minMotorRPM;
-        }
-
-        /// @brief Size in tooth count of the input gear
-        /// @param inGearSize [double] gear tooth count
-        void Set_IN_GEAR_SIZE(int inGearSize)
-        {
-            _inGearSize = inGearSize;
-        }
-
-        /// @brief Size in tooth count of the output gear
-        /// @param inGearSize [double] gear tooth count
-        void Set_OUT_GEAR_SIZE(int outGearSize)
-        {
-            _outGearSize = outGearSize;
-        }
-
-        /// @brief Circumference of drive wheel/s in mm
-        /// @param wheelCircumference [double] circunference of drive wheel
-        void Set_WHEEL_CIRCUMFERENCE(double wheelCircumference)
-        {
-            _wheelCircumference = wheelCircumference;
-        }
-
-        /// @brief Maximum motor RPM value to be used in this library
-        /// @param maxMotorRPM [int] maximun value
-        void Set_MAX_MOTOR_RPM(double maxMotorRPM)
-        {
-            _maxMotorRPM = maxMotorRPM;
-        }
-
-        void CalibrateGyro();
-        void TurnToHeading(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps = 10);
-};
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       MinSixAutoDrivetrain.h                                    */
+/*    Author:       Raiford G. Bonnell                                        */
+/*    Created:      3/28/2025, 7:51:13 PM                                     */
+/*    Description:  Drivetrain library for 6 wheel IQ drivetrain              */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#include <math.h> 
+#include <atomic>
+#include "DrivetrainHardware.h"
+#include "ControlScalar.h"
+#include "DrivetrainIO.h"
+#include "PlatformThread.h"
+#include "TelemetryRing.h"
+#include "RoutineTable.h"
+#include "StatusDisplay.h"
+#include "LoopProfiler.h"
+#include "DrivetrainConfig.h"
+
+#ifndef MinSixAutoDrivetrain
+#define MinSixAutoDrivetrain
+class ControlLoopTimer;
+class Min6AutoDrivetrain;
+
+/// @brief Outcome of a relay feedback auto-tune on one axis
+struct AutoTuneResult
+{
+    bool Valid;             //False if no steady oscillation was measured
+    double UltimateGain;    //Ku [RPM per deg] turning, [RPM per mm] driving
+    double UltimatePeriod;  //Pu [sec]
+    double Amplitude;       //[deg] or [mm] half the peak to peak oscillation
+    double Kp;
+    double Ki;
+    double Kd;
+};
+
+/// @brief Outcome of a feedforward characterization on one axis. Command [RPM] = kV*v + kA*a while moving,
+/// plus kS while the bot is at rest and should move.
+struct FeedforwardResult
+{
+    bool Valid;             //False if the bot never moved or too few moving samples were collected
+    double Ks;              //[RPM] command at which the bot breaks free of static friction
+    double Kv;              //[RPM per deg/sec] turning, [RPM per mm/sec] driving
+    double Ka;              //[RPM per deg/sec^2] turning, [RPM per mm/sec^2] driving
+    int Samples;            //Moving samples in the fit
+};
+
+/// @brief Handle to a motion queued on the drivetrain task. Copies refer to the same motion.
+class MotionHandle
+{
+    private:
+        Min6AutoDrivetrain *m_Drivetrain;
+        uint32_t _id;
+
+    public:
+        MotionHandle() : m_Drivetrain(0), _id(0) {}
+        MotionHandle(Min6AutoDrivetrain *Drivetrain, uint32_t Id) : m_Drivetrain(Drivetrain), _id(Id) {}
+
+        /// @brief Has the motion finished, timed out or been cancelled
+        /// @return [bool] true once the drivetrain is done with it, always true for an empty handle
+        bool isDone();
+
+        /// @brief Block the calling task until the motion is done
+        void wait();
+
+        /// @brief Abort the motion. A queued motion is skipped, a running one stops within one control tick.
+        void cancel();
+};
+
+class Min6AutoDrivetrain
+{
+    private:
+        IBrainHardware &m_Brain;
+        IInertialSensor &m_BrainInertial;
+        IDriveMotor &m_RightDriveMotor;
+        IDriveMotor &m_LeftDriveMotor;
+        IDistanceSensor *m_FrontDistance;
+        IOpticalSensor *m_FrontOptical;
+        StatusDisplay *m_Status;
+        LoopProfiler *m_Profiler;
+        DrivetrainIO m_IO;
+        
+        int _inGearSize;
+        int _outGearSize;
+        ControlScalar _wheelCircumference;
+        ControlScalar _trackWidth;
+        ControlScalar _maxMotorRPM;
+        uint32_t _controlPeriodMs;
+        //Unit conversions from the geometry, refreshed by the Set_ functions so the control loops only multiply
+        ControlScalar _mmPerMotorDeg;
+        ControlScalar _rpmPerMmPerSec;
+        ControlScalar _turnRPMPerDegPerSec;
+        ControlScalar _halfTrack;           //[mm]
+        ControlScalar _tickSec;             //[sec] control period
+        ControlScalar _tickRate;            //[1/sec] control rate
+        ControlScalar _turnKp;
+        ControlScalar _turnKi;
+        ControlScalar _turnKd;
+        ControlScalar _turnJerk;
+        ControlScalar _turnSettleRate;
+        ControlScalar _turnSettleTime;
+        ControlScalar _turnKs;
+        ControlScalar _turnKv;
+        ControlScalar _turnKa;
+        ControlScalar _driveKp;
+        ControlScalar _driveKi;
+        ControlScalar _driveKd;
+        ControlScalar _driveJerk;
+        ControlScalar _driveKs;
+        ControlScalar _driveKv;
+        ControlScalar _driveKa;
+        ControlScalar _headingKp;
+        ControlScalar _headingKi;
+        ControlScalar _headingKd;
+        ControlScalar _maxLateralAcceleration;
+        ControlScalar _batteryNominalVolts;
+        ControlScalar _batteryFloorVolts;
+        ControlScalar _batteryVolts;            //[V] sampled at the start of the last motion
+        ControlScalar _batteryCompensation;     //Command scale for the last motion, 1 when off
+
+        static const int TelemetryCapacity = 256;
+        TelemetryRing<TelemetryCapacity> _telemetry;
+        PlatformTask _telemetryTask;
+        uint16_t _motionCount;
+        uint16_t _dumpedMotion;
+        int _dumpedDropped;
+
+        //Async motion: a small queue drained in order by the drivetrain task
+        struct MotionCommand
+        {
+            enum Kinds
+            {
+                Turn,
+                Drive,
+                DriveUntil,
+                Arc,
+                Path,
+                Routine
+            };
+            Kinds Kind;
+            uint32_t Id;
+            bool Cancelled;
+            double Target;          //[deg] heading, [mm] distance, [deg] arc angle or [mm] path lookahead
+            double Velocity;        //[RPM]
+            double TimeOut;         //[sec]
+            double Tolerance;       //[deg] turns only
+            int AccertionSteps;
+            const RoutineTable *Table;  //Routine only
+            DriveTrigger Trigger;       //DriveUntil only
+            double Radius;              //[mm] Arc only
+            const PathPoint *Points;    //Path only
+            int PointCount;             //Path only
+        };
+        static const int MotionQueueCapacity = 8;
+        MotionCommand _motionQueue[MotionQueueCapacity];
+        int _motionQueueHead;
+        int _motionQueueCount;
+        uint32_t _nextMotionId;
+        uint32_t _runningMotionId;
+        std::atomic<uint32_t> _completedMotionId;
+        std::atomic<uint32_t> _cancelCount;     //Bumped by every cancel, a motion stops when it changes
+        PlatformMutex _motionLock;
+        PlatformTask _motionTask;
+        PlatformTask _odometryTask;
+        ControlScalar _motionStartRotation; //[deg] inertial rotation at the start of the current motion, for telemetry
+        uint16_t _motionKind;           //TelemetryTurn, TelemetryDrive or 0, for telemetry
+        bool _triggerFired;             //The trigger of the last DriveSegment ended it
+
+        //Gyro calibration, run on the gyro task from boot
+        enum GyroRequests
+        {
+            GyroNone,
+            GyroFull,
+            GyroQuick
+        };
+        static const uint32_t GyroPollMs = 10;
+        std::atomic<bool> _gyroReady;
+        std::atomic<bool> _gyroCalibrated;  //A full calibration has run in this power cycle
+        std::atomic<int> _gyroRequest;      //GyroRequests, the calibration the gyro task runs next
+        std::atomic<bool> _gyroBiasValid;   //_gyroBias was measured since the last full calibration
+        double _gyroBias;                   //[deg/sec] drift of the still sensor after the last full calibration
+        PlatformTask _gyroTask;
+
+        friend class TickBenchmark;     //Times the private tick math
+        static ControlScalar HeadingError(ControlScalar Target, ControlScalar Current);
+        void LogMotionEnd(ControlLoopTimer &loop);
+        void RecordTick(ControlScalar Target, ControlScalar CommandRPM, ControlScalar ElapsedSec, bool OnTime);
+        bool BeginMotion();
+        const DrivetrainSnapshot &SampleSensors();
+        void CommandMotors(ControlScalar LeftRPM, ControlScalar RightRPM);
+        template <typename TickBody>
+        void RunControlLoop(ControlLoopTimer &loop, uint32_t CancelCount, ControlScalar TimeOut, TickBody Tick);
+        MotionHandle QueueMotion(MotionCommand &Command);
+        void TurnSegment(ControlScalar Heading, ControlScalar TurnVelocity, ControlScalar TimeOut, ControlScalar HeadingTolerance, int AccertionSteps, bool StopAtEnd,
+                         uint32_t CancelCount);
+        ControlScalar DriveSegment(ControlScalar Distance, ControlScalar DriveVelocity, ControlScalar TimeOut, int AccertionSteps,
+                                   ControlScalar EntryRPM, ControlScalar ExitRPM, ControlScalar StartOffset, bool StopAtEnd,
+                                   uint32_t CancelCount, ControlScalar Curvature = 0, const DriveTrigger *Trigger = 0);
+        void ArcSegment(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps, uint32_t CancelCount);
+        bool PathSegment(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps, uint32_t CancelCount);
+        void RoutineSegment(const RoutineTable &Routine, uint32_t CancelCount);
+        ControlScalar CurvatureRPM(ControlScalar DriveVelocity, ControlScalar Curvature);
+        double StepDistance(const RoutineStep &Step);
+        ControlScalar StepCurvature(const RoutineStep &Step);
+        bool TriggerSensorAttached(const DriveTrigger &Trigger);
+        bool ReadTrigger(const DriveTrigger &Trigger, ControlScalar &RangeMm);
+        ControlScalar UpdateBatteryCompensation();
+        void UpdateConversions();
+        static int MotionTaskEntry(void *Arg);
+        static int GyroTaskEntry(void *Arg);
+        AutoTuneResult RelayExperiment(bool DriveAxis, ControlScalar RelayRPM, ControlScalar Hysteresis, int Cycles, ControlScalar TimeOut);
+        FeedforwardResult FeedforwardExperiment(bool DriveAxis, ControlScalar MaxRPM, ControlScalar RampRPMPerSec, ControlScalar TimeOut);
+
+    public:    
+        enum LogLevels
+        {
+            None,
+            CallsOnly,
+            Verbose
+        };
+        LogLevels _logLevel;
+        static const int MaxLogLevel = MINSIX_LOG_LEVEL;
+
+        /// @brief Is output at a log level on. Levels above MINSIX_LOG_LEVEL are constant false, so the compiler
+        /// drops their logging code.
+        bool Logging(LogLevels Level) const
+        {
+            return ((int)Level <= MaxLogLevel) && (_logLevel >= Level);
+        }
+
+        enum TuneRules
+        {
+            Fast,           //Ziegler-Nichols: quickest response, some overshoot
+            NoOvershoot     //Ziegler-Nichols no overshoot variant
+        };
+
+        /// @brief Drivetrain on stock IQ wheels driven 1:1, until the Set_ functions give the real geometry
+        /// @param Brain [IBrainHardware] timer, sleep and screen
+        /// @param BrainInertial [IInertialSensor] heading sensor
+        /// @param RightDriveMotoer [IDriveMotor] right side drive motor
+        /// @param LeftDriveMotor [IDriveMotor] left side drive motor
+        Min6AutoDrivetrain(IBrainHardware &Brain, 
+                           IInertialSensor &BrainInertial,
+                           IDriveMotor &RightDriveMotoer, 
+                           IDriveMotor &LeftDriveMotor) 
+                        : Min6AutoDrivetrain(Brain, BrainInertial, RightDriveMotoer, LeftDriveMotor, DrivetrainConfig(1, 1, 200.0, 170.0, 100.0))
+        {}
+
+        /// @brief Drivetrain with its geometry and limits set from a config, usually a constexpr one
+        /// @param Brain [IBrainHardware] timer, sleep and screen
+        /// @param BrainInertial [IInertialSensor] heading sensor
+        /// @param RightDriveMotoer [IDriveMotor] right side drive motor
+        /// @param LeftDriveMotor [IDriveMotor] left side drive motor
+        /// @param Config [DrivetrainConfig] gears, wheel, track width, motor limits and control period
+        Min6AutoDrivetrain(IBrainHardware &Brain, 
+                           IInertialSensor &BrainInertial,
+                           IDriveMotor &RightDriveMotoer, 
+                           IDriveMotor &LeftDriveMotor,
+                           const DrivetrainConfig &Config) 
+                        : m_Brain(Brain)
+                        , m_BrainInertial(BrainInertial)
+                        , m_RightDriveMotor(RightDriveMotoer)
+                        , m_LeftDriveMotor(LeftDriveMotor)
+                        , m_FrontDistance(0)
+                        , m_FrontOptical(0)
+                        , m_Status(0)
+                        , m_Profiler(0)
+                        , m_IO(Brain, BrainInertial, RightDriveMotoer, LeftDriveMotor)
+                        , _inGearSize(Config.InGearSize)
+                        , _outGearSize(Config.OutGearSize)
+                        , _wheelCircumference((ControlScalar)Config.WheelCircumference)
+                        , _trackWidth((ControlScalar)Config.TrackWidth)
+                        , _maxMotorRPM((ControlScalar)Config.MaxMotorRPM)
+                        , _controlPeriodMs(Config.ControlPeriodMs)
+                        , _mmPerMotorDeg((ControlScalar)Config.MmPerMotorDeg())
+                        , _rpmPerMmPerSec((ControlScalar)Config.RPMPerMmPerSec())
+                        , _turnRPMPerDegPerSec((ControlScalar)Config.TurnRPMPerDegPerSec())
+                        , _halfTrack((ControlScalar)(Config.TrackWidth / 2.0))
+                        , _tickSec((ControlScalar)Config.TickSec())
+                        , _tickRate((ControlScalar)(1.0 / Config.TickSec()))
+                        , _turnKp(1.0)
+                        , _turnKi(0.0)
+                        , _turnKd(0.1)
+                        , _turnJerk(0.0)
+                        , _turnSettleRate(5.0)
+                        , _turnSettleTime(0.1)
+                        , _turnKs((ControlScalar)Config.MinMotorRPM)
+                        , _turnKv(0.0)
+                        , _turnKa(0.0)
+                        , _driveKp(0.1)
+                        , _driveKi(0.0)
+                        , _driveKd(0.01)
+                        , _driveJerk(0.0)
+                        , _driveKs((ControlScalar)Config.MinMotorRPM)
+                        , _driveKv(0.0)
+                        , _driveKa(0.0)
+                        , _headingKp(3.0)
+                        , _headingKi(0.0)
+                        , _headingKd(0.0)
+                        , _maxLateralAcceleration(0.0)
+                        , _batteryNominalVolts(0.0)
+                        , _batteryFloorVolts(0.0)
+                        , _batteryVolts(0.0)
+                        , _batteryCompensation(1.0)
+                        , _motionCount(0)
+                        , _dumpedMotion(0)
+                        , _dumpedDropped(0)
+                        , _motionQueueHead(0)
+                        , _motionQueueCount(0)
+                        , _nextMotionId(1)
+                        , _runningMotionId(0)
+                        , _completedMotionId(0)
+                        , _cancelCount(0)
+                        , _motionStartRotation(0)
+                        , _motionKind(0)
+                        , _triggerFired(false)
+                        , _gyroReady(false)
+                        , _gyroCalibrated(false)
+                        , _gyroRequest(GyroNone)
+                        , _gyroBiasValid(false)
+                        , _gyroBias(0)
+                        , _logLevel(None)
+        {}
+
+        /// @brief Set the output log level
+        /// @param logLevel [LogLevels enum] log level value
+        void Set_LogLevel(LogLevels logLevel)
+        {
+            _logLevel = logLevel;
+        }
+
+        /// @brief Smallest motor velocity in RPMs which will result in bot motion. Sets the static friction
+        /// feedforward (kS) of both turning and driving, see Set_TURN_FEEDFORWARD and Set_DRIVE_FEEDFORWARD.
+        /// @param minimalVelocity [double] - minimal velocity value
+        void Set_MINIMAL_MOTOR_RPM(double minMotorRPM)
+        {
+            _turnKs = minMotorRPM;
+            _driveKs = minMotorRPM;
+        }
+
+        /// @brief Size in tooth count of the input gear
+        /// @param inGearSize [double] gear tooth count
+        void Set_IN_GEAR_SIZE(int inGearSize)
+        {
+            _inGearSize = inGearSize;
+            UpdateConversions();
+        }
+
+        /// @brief Size in tooth count of the output gear
+        /// @param inGearSize [double] gear tooth count
+        void Set_OUT_GEAR_SIZE(int outGearSize)
+        {
+            _outGearSize = outGearSize;
+            UpdateConversions();
+        }
+
+        /// @brief Circumference of drive wheel/s in mm
+        /// @param wheelCircumference [double] circunference of drive wheel
+        void Set_WHEEL_CIRCUMFERENCE(double wheelCircumference)
+        {
+            _wheelCircumference = wheelCircumference;
+            UpdateConversions();
+        }
+
+        /// @brief Distance between the left and right wheels in mm
+        /// @param trackWidth [double] wheel center to wheel center
+        void Set_TRACK_WIDTH(double trackWidth)
+        {
+            _trackWidth = trackWidth;
+            UpdateConversions();
+        }
+
+        /// @brief Maximum motor RPM value to be used in this library
+        /// @param maxMotorRPM [int] maximun value
+        void Set_MAX_MOTOR_RPM(double maxMotorRPM)
+        {
+            _maxMotorRPM = maxMotorRPM;
+        }
+
+        /// @brief Period of the motion control loops
+        /// @param controlPeriodMs [ms] loop period, 5 gives a 200Hz loop
+        void Set_CONTROL_PERIOD_MS(uint32_t controlPeriodMs)
+        {
+            _controlPeriodMs = controlPeriodMs;
+            UpdateConversions();
+        }
+
+        /// @brief Turn controller gains. The controller corrects the motion profile with motor RPM per degree of rotation error.
+        /// @param kp [double] proportional gain [RPM/deg]
+        /// @param ki [double] integral gain [RPM/(deg*sec)]
+        /// @param kd [double] derivative gain [RPM/(deg/sec)]
+        void Set_TURN_PID(double kp, double ki, double kd)
+        {
+            _turnKp = kp;
+            _turnKi = ki;
+            _turnKd = kd;
+        }
+
+        /// @brief Jerk limit of the turn motion profile, 0 for a trapezoidal profile
+        /// @param turnJerk [double] limit in motor RPM/sec^2
+        void Set_TURN_JERK(double turnJerk)
+        {
+            _turnJerk = turnJerk;
+        }
+
+        /// @brief Turn feedforward, the motor command the profile asks for before feedback. Measure with CharacterizeTurn.
+        /// @param ks [RPM] added while the bot is at rest and should turn, to break static friction
+        /// @param kv [RPM/(deg/sec)] per degree per second of rotation, 0 uses the drive geometry
+        /// @param ka [RPM/(deg/sec^2)] per degree per second squared of rotation
+        void Set_TURN_FEEDFORWARD(double ks, double kv, double ka)
+        {
+            _turnKs = ks;
+            _turnKv = kv;
+            _turnKa = ka;
+        }
+
+        /// @brief When a turn counts as finished: inside the heading tolerance and turning slower than settleRate for settleTime
+        /// @param settleRate [deg/sec] largest rotation rate counted as stopped
+        /// @param settleTime [sec] dwell time inside the tolerance before the turn ends
+        void Set_TURN_SETTLE(double settleRate, double settleTime)
+        {
+            _turnSettleRate = settleRate;
+            _turnSettleTime = settleTime;
+        }
+
+        /// @brief Drive controller gains, correcting the distance profile with motor RPM per mm of error.
+        /// @param kp [double] proportional gain [RPM/mm]
+        /// @param ki [double] integral gain [RPM/(mm*sec)]
+        /// @param kd [double] derivative gain [RPM/(mm/sec)]
+        void Set_DRIVE_PID(double kp, double ki, double kd)
+        {
+            _driveKp = kp;
+            _driveKi = ki;
+            _driveKd = kd;
+        }
+
+        /// @brief Drive feedforward, the motor command the profile asks for before feedback. Measure with CharacterizeDrive.
+        /// @param ks [RPM] added while the bot is at rest and should drive, to break static friction
+        /// @param kv [RPM/(mm/sec)] per mm per second of travel, 0 uses the drive geometry
+        /// @param ka [RPM/(mm/sec^2)] per mm per second squared of travel
+        void Set_DRIVE_FEEDFORWARD(double ks, double kv, double ka)
+        {
+            _driveKs = ks;
+            _driveKv = kv;
+            _driveKa = ka;
+        }
+
+        /// @brief Jerk limit of the drive motion profile, 0 for a trapezoidal profile
+        /// @param driveJerk [double] limit in motor RPM/sec^2
+        void Set_DRIVE_JERK(double driveJerk)
+        {
+            _driveJerk = driveJerk;
+        }
+
+        /// @brief Heading hold gains used while driving straight, motor RPM of steering per degree of drift.
+        /// @param kp [double] proportional gain [RPM/deg]
+        /// @param ki [double] integral gain [RPM/(deg*sec)]
+        /// @param kd [double] derivative gain [RPM/(deg/sec)]
+        void Set_HEADING_HOLD_PID(double kp, double ki, double kd)
+        {
+            _headingKp = kp;
+            _headingKi = ki;
+            _headingKd = kd;
+        }
+
+        /// @brief Sideways acceleration limit on arcs and paths. Arcs and paths always keep the outer wheel inside the
+        /// drive velocity; this also slows them on tight curves so the bot does not slide off the line.
+        /// @param maxLateralAcceleration [mm/sec^2] limit, 0 for none
+        void Set_MAX_LATERAL_ACCELERATION(double maxLateralAcceleration)
+        {
+            _maxLateralAcceleration = maxLateralAcceleration;
+        }
+
+        /// @brief Distance sensor facing forward, used by DriveUntil range and standoff triggers
+        /// @param frontDistance [IDistanceSensor] sensor, must outlive the drivetrain
+        void Set_FRONT_DISTANCE_SENSOR(IDistanceSensor &frontDistance)
+        {
+            m_FrontDistance = &frontDistance;
+        }
+
+        /// @brief Optical sensor looking at the floor, used by DriveUntil line and colour triggers
+        /// @param frontOptical [IOpticalSensor] sensor, must outlive the drivetrain
+        void Set_FRONT_OPTICAL_SENSOR(IOpticalSensor &frontOptical)
+        {
+            m_FrontOptical = &frontOptical;
+        }
+
+        /// @brief Battery voltage compensation. The battery is sampled at the start of every motion and the static friction,
+        /// acceleration and feedback parts of the motor command are scaled by nominalVolts / measured volts, so a sagging pack
+        /// follows the profile like the one the gains were tuned on. The kV part is left alone: the motors hold velocity themselves.
+        /// @param nominalVolts [V] battery voltage the gains were tuned at, 0 turns compensation off
+        /// @param floorVolts [V] lowest voltage compensated for, lower readings are scaled as this voltage
+        void Set_BATTERY_COMPENSATION(double nominalVolts, double floorVolts)
+        {
+            _batteryNominalVolts = nominalVolts;
+            _batteryFloorVolts = floorVolts;
+        }
+
+        /// @return [V] battery voltage sampled at the start of the last motion
+        double GET_BatteryVoltage()
+        {
+            return _batteryVolts;
+        }
+
+        /// @return [double] command scale applied in the last motion, 1 when compensation is off
+        double GET_BatteryCompensation()
+        {
+            return _batteryCompensation;
+        }
+
+        /// @brief Status display the drivetrain reports gyro calibration on, screen row 1. Without one nothing is shown.
+        /// @param status [StatusDisplay] display, must outlive the drivetrain
+        void Set_STATUS_DISPLAY(StatusDisplay &status)
+        {
+            m_Status = &status;
+        }
+
+        /// @brief Time every control tick into a loop profiler: sensor reads, compute, motor writes and telemetry
+        /// @param profiler [LoopProfiler*] profiler to fill, 0 to stop timing
+        void Set_LOOP_PROFILER(LoopProfiler *profiler)
+        {
+            m_Profiler = profiler;
+        }
+
+        void CalibrateGyro(bool Quick = false);
+        bool MeasureGyroBias(double SampleSec = 2.0);
+        void StartGyroCalibration(bool Quick = false);
+        bool IsGyroReady();
+        void StartTelemetryTask();
+        void DumpTelemetry();
+        void StartMotionTask();
+        void StartOdometryTask();
+        void UpdatePoseIdle();
+        Pose GetPose();
+        void ResetPose(double X = 0, double Y = 0);
+        void TurnToHeading(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps = 10);
+        void DriveDistance(double Distance, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        bool DriveUntil(const DriveTrigger &Trigger, double MaxDistance, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        void ArcTurn(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        bool FollowPath(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps = 10);
+        AutoTuneResult AutoTuneTurn(double RelayRPM, TuneRules Rule, double Hysteresis = 0.5, int Cycles = 6, double TimeOut = 10);
+        AutoTuneResult AutoTuneDrive(double RelayRPM, TuneRules Rule, double Hysteresis = 2.0, int Cycles = 6, double TimeOut = 10);
+        void ApplyTuneRule(AutoTuneResult &Result, TuneRules Rule);
+        FeedforwardResult CharacterizeTurn(double MaxRPM = 60, double RampRPMPerSec = 20, double TimeOut = 10);
+        FeedforwardResult CharacterizeDrive(double MaxRPM = 60, double RampRPMPerSec = 20, double TimeOut = 10);
+        void RunRoutine(const RoutineTable &Routine);
+        MotionHandle RunRoutineAsync(const RoutineTable &Routine);
+        MotionHandle TurnToHeadingAsync(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps = 10);
+        MotionHandle DriveDistanceAsync(double Distance, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        MotionHandle DriveUntilAsync(const DriveTrigger &Trigger, double MaxDistance, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        MotionHandle ArcTurnAsync(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps = 10);
+        MotionHandle FollowPathAsync(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps = 10);
+        bool IsMotionDone(uint32_t Id);
+        void CancelMotion(uint32_t Id);
+        void CancelAllMotion();
+};
 #endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#include "DrivetrainConfig.h"
+
+#ifndef MinSix_Config
+#define MinSix_Config
+
+/// @brief The Min 6 bot: 48:24 gears, 230mm wheels, 170mm track, 110 RPM top speed, 5 RPM static friction,
+/// 20ms control loop. main.cpp builds the drivetrain from it and the host tools simulate the same bot.
+constexpr DrivetrainConfig gMinSixConfig(48, 24, 230.0, 170.0, 110.0, 5.0, 20);
+static_assert(gMinSixConfig.Valid(), "Drivetrain geometry must be positive and MinMotorRPM below MaxMotorRPM");
+
+#endif
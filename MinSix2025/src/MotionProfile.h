@@ -0,0 +1,272 @@
+#include "ControlScalar.h"
+
+#ifndef Motion_Profile
+#define Motion_Profile
+
+/// @brief Setpoint of a motion profile at one instant
+template <typename Scalar>
+struct ProfileStateT
+{
+    Scalar Position;
+    Scalar Velocity;
+    Scalar Acceleration;
+};
+
+/// @brief Time parameterized trapezoidal (jerk limit 0) or S-curve motion profile.
+/// Units are whatever the caller plans in (deg, deg/s, deg/s^2 for turns; mm, mm/s, mm/s^2 for drives).
+/// @tparam Scalar [float|double] type of the plan and the setpoints, use MotionProfile for the control scalar of the build
+template <typename Scalar>
+class MotionProfileT
+{
+    private:
+    struct Segment
+    {
+        Scalar StartTime;
+        Scalar Duration;
+        Scalar Position;
+        Scalar Velocity;
+        Scalar Acceleration;
+        Scalar Jerk;
+    };
+
+    static const int MaxSegments = 7;
+    Segment _segments[MaxSegments];
+    int _segmentCount;
+    Scalar _direction;
+    Scalar _duration;
+    Scalar _peakVelocity;
+    Scalar _maxAcceleration;
+    Scalar _maxJerk;
+    ProfileStateT<Scalar> _end;
+
+    /// @brief Jerk and constant acceleration times needed to change velocity by dv
+    void PhaseTiming(Scalar dv, Scalar &JerkTime, Scalar &AccelTime)
+    {
+        dv = ScalarAbs(dv);
+        if (_maxJerk <= 0)
+        {
+            JerkTime = 0;
+            AccelTime = dv / _maxAcceleration;
+        }
+        else if (dv >= (_maxAcceleration * _maxAcceleration / _maxJerk))
+        {
+            JerkTime = _maxAcceleration / _maxJerk;
+            AccelTime = (dv / _maxAcceleration) - JerkTime;
+        }
+        else
+        {
+            //Acceleration limit never reached: triangular acceleration
+            JerkTime = ScalarSqrt(dv / _maxJerk);
+            AccelTime = 0;
+        }
+    }
+
+    /// @brief Distance covered changing velocity from v0 to v1. The phase is symmetric so the mean velocity is the midpoint.
+    Scalar PhaseDistance(Scalar v0, Scalar v1)
+    {
+        Scalar jerkTime, accelTime;
+        PhaseTiming(v1 - v0, jerkTime, accelTime);
+        return ((v0 + v1) / Scalar(2)) * ((Scalar(2) * jerkTime) + accelTime);
+    }
+
+    /// @brief Append a segment starting from the end state of the previous one
+    void AddSegment(Scalar Duration, Scalar Acceleration, Scalar Jerk)
+    {
+        if ((Duration <= 0) || (_segmentCount >= MaxSegments)) return;
+        Segment &segment = _segments[_segmentCount++];
+        segment.StartTime = _duration;
+        segment.Duration = Duration;
+        segment.Position = _end.Position;
+        segment.Velocity = _end.Velocity;
+        segment.Acceleration = Acceleration;
+        segment.Jerk = Jerk;
+        _end = Evaluate(segment, Duration);
+        _end.Acceleration = 0;
+        _duration += Duration;
+    }
+
+    /// @brief Append the segments that change velocity from v0 to v1
+    void AddPhase(Scalar v0, Scalar v1)
+    {
+        Scalar jerkTime, accelTime;
+        PhaseTiming(v1 - v0, jerkTime, accelTime);
+        Scalar sign = (v1 >= v0) ? Scalar(1) : Scalar(-1);
+        if (_maxJerk <= 0)
+        {
+            AddSegment(accelTime, sign * _maxAcceleration, 0);
+        }
+        else
+        {
+            Scalar peakAcceleration = _maxJerk * jerkTime;
+            AddSegment(jerkTime, 0, sign * _maxJerk);
+            AddSegment(accelTime, sign * peakAcceleration, 0);
+            AddSegment(jerkTime, sign * peakAcceleration, -sign * _maxJerk);
+        }
+        _end.Velocity = v1;
+    }
+
+    static ProfileStateT<Scalar> Evaluate(const Segment &segment, Scalar t)
+    {
+        ProfileStateT<Scalar> state;
+        state.Position = segment.Position + (segment.Velocity * t) + (segment.Acceleration * t * t / Scalar(2)) + (segment.Jerk * t * t * t / Scalar(6));
+        state.Velocity = segment.Velocity + (segment.Acceleration * t) + (segment.Jerk * t * t / Scalar(2));
+        state.Acceleration = segment.Acceleration + (segment.Jerk * t);
+        return state;
+    }
+
+    public:
+    MotionProfileT() : _segmentCount(0), _direction(1), _duration(0), _peakVelocity(0), _maxAcceleration(1), _maxJerk(0)
+    {
+        _end.Position = 0;
+        _end.Velocity = 0;
+        _end.Acceleration = 0;
+    }
+
+    /// @brief Plan a minimum time move
+    /// @param Distance [units] signed distance to travel
+    /// @param MaxVelocity [units/s] cruise velocity limit
+    /// @param MaxAcceleration [units/s^2] acceleration limit
+    /// @param MaxJerk [units/s^3][Optional] jerk limit, 0 for a trapezoidal profile
+    /// @param StartVelocity [units/s][Optional] speed already moving in the direction of travel
+    /// @param EndVelocity [units/s][Optional] speed to arrive with, lowered if it cannot be reached in Distance
+    void Plan(Scalar Distance, Scalar MaxVelocity, Scalar MaxAcceleration, Scalar MaxJerk = 0, Scalar StartVelocity = 0, Scalar EndVelocity = 0)
+    {
+        _segmentCount = 0;
+        _duration = 0;
+        _direction = (Distance < 0) ? Scalar(-1) : Scalar(1);
+        _maxAcceleration = (MaxAcceleration > 0) ? MaxAcceleration : Scalar(1);
+        _maxJerk = (MaxJerk > 0) ? MaxJerk : 0;
+        Scalar distance = ScalarAbs(Distance);
+        Scalar vMax = ScalarAbs(MaxVelocity);
+        Scalar v0 = ScalarAbs(StartVelocity);
+        Scalar vf = ScalarAbs(EndVelocity);
+        if (v0 > vMax) v0 = vMax;
+        if (vf > vMax) vf = vMax;
+
+        _end.Position = 0;
+        _end.Velocity = v0;
+        _end.Acceleration = 0;
+        _peakVelocity = v0;
+        if (distance <= 0) return;
+
+        if (PhaseDistance(v0, vf) >= distance)
+        {
+            //Not enough room to reach the requested end speed: go straight toward it and arrive at whatever speed the distance allows
+            Scalar low = (v0 < vf) ? v0 : vf;
+            Scalar high = (v0 < vf) ? vf : v0;
+            for (int i = 0; i < 40; i++)
+            {
+                Scalar mid = (low + high) / Scalar(2);
+                bool tooFar = PhaseDistance(v0, mid) > distance;
+                if (tooFar == (vf > v0)) high = mid;
+                else low = mid;
+            }
+            vf = (low + high) / Scalar(2);
+            AddPhase(v0, vf);
+            _peakVelocity = (v0 > vf) ? v0 : vf;
+        }
+        else
+        {
+            //Highest peak velocity whose accel and decel phases fit in the distance
+            Scalar peak = vMax;
+            if ((PhaseDistance(v0, peak) + PhaseDistance(peak, vf)) > distance)
+            {
+                Scalar low = (v0 > vf) ? v0 : vf;
+                Scalar high = vMax;
+                for (int i = 0; i < 40; i++)
+                {
+                    Scalar mid = (low + high) / Scalar(2);
+                    if ((PhaseDistance(v0, mid) + PhaseDistance(mid, vf)) > distance) high = mid;
+                    else low = mid;
+                }
+                peak = low;
+            }
+            Scalar cruise = distance - PhaseDistance(v0, peak) - PhaseDistance(peak, vf);
+            AddPhase(v0, peak);
+            if (peak > 0) AddSegment(cruise / peak, 0, 0);
+            AddPhase(peak, vf);
+            _peakVelocity = peak;
+        }
+        _end.Position = distance;
+    }
+
+    /// @brief Distance needed to come to rest from a speed without breaking the acceleration and jerk limits
+    /// @param Velocity [units/s] current speed, either sign
+    /// @param MaxAcceleration [units/s^2] acceleration limit
+    /// @param MaxJerk [units/s^3][Optional] jerk limit, 0 for a trapezoidal profile
+    /// @return [units] unsigned stopping distance
+    static Scalar StoppingDistance(Scalar Velocity, Scalar MaxAcceleration, Scalar MaxJerk = 0)
+    {
+        MotionProfileT limits;
+        limits._maxAcceleration = (MaxAcceleration > 0) ? MaxAcceleration : Scalar(1);
+        limits._maxJerk = (MaxJerk > 0) ? MaxJerk : 0;
+        return limits.PhaseDistance(ScalarAbs(Velocity), 0);
+    }
+
+    /// @brief Setpoint at a time since the start of the move
+    /// @param Time [sec] elapsed time
+    /// @return [ProfileState] signed position, velocity and acceleration
+    ProfileStateT<Scalar> Sample(Scalar Time)
+    {
+        ProfileStateT<Scalar> state;
+        if ((_segmentCount == 0) || (Time >= _duration))
+        {
+            state = _end;
+        }
+        else if (Time <= 0)
+        {
+            state.Position = 0;
+            state.Velocity = _segments[0].Velocity;
+            state.Acceleration = _segments[0].Acceleration;
+        }
+        else
+        {
+            int i = 0;
+            while ((i < (_segmentCount - 1)) && (Time >= (_segments[i].StartTime + _segments[i].Duration))) i++;
+            state = Evaluate(_segments[i], Time - _segments[i].StartTime);
+        }
+        state.Position *= _direction;
+        state.Velocity *= _direction;
+        state.Acceleration *= _direction;
+        return state;
+    }
+
+    /// @brief Sample the profile at a fixed rate into a table
+    /// @param Table [ProfileState*] destination
+    /// @param MaxEntries [int] table size
+    /// @param Dt [sec] time between entries
+    /// @return [int] number of entries written, the last one is the end of the move when the table is large enough
+    int Precompute(ProfileStateT<Scalar> *Table, int MaxEntries, Scalar Dt)
+    {
+        int count = 0;
+        while (count < MaxEntries)
+        {
+            Scalar t = count * Dt;
+            Table[count++] = Sample(t);
+            if (t >= _duration) break;
+        }
+        return count;
+    }
+
+    /// @return [sec] time to complete the move
+    Scalar GET_Duration()
+    {
+        return _duration;
+    }
+
+    /// @return [units/s] highest speed reached
+    Scalar GET_PeakVelocity()
+    {
+        return _peakVelocity;
+    }
+
+    /// @return [units/s] signed speed at the end of the move
+    Scalar GET_EndVelocity()
+    {
+        return _end.Velocity * _direction;
+    }
+};
+
+typedef ProfileStateT<ControlScalar> ProfileState;
+typedef MotionProfileT<ControlScalar> MotionProfile;
+#endif
@@ -1,39 +1,210 @@
-#ifndef PID_CONTROLLER
-#define PID_CONTROLLER
-class PIDController 
-{
-private:
-    double Kp, Ki, Kd;
-    double previousError, integral;
-
-public:
-    /// @brief Class to calculate error signal using PID method
-    /// @param p [double] Proportional Coefficient
-    /// @param i [double] Integral Coefficient
-    /// @param d [double] Derivative Coefficient
-    PIDController(double p, double i, double d) : Kp(p), Ki(i), Kd(d), previousError(0), integral(0) {}
-
-    /// @brief Calculate a new control signal 
-    /// @param error [double] Measured error
-    /// @return [double] Calculated control signal
-    double calculateControlSignal(double error) 
-    {
-        //calculate the proportional value by applying the proportional coefficient to the error. 
-        double proportional = Kp * error;
-        
-        //add the current error to the integral value.
-        integral += error;
-        
-        //calculate the derivative value by comparing the current error to the past error
-        double derivative = error - previousError;
-
-        //calculate the output by adding the proportional value to the integral (with coefficient) and adding the derivative (with coefficient) to the sum.
-        double output = proportional + Ki * integral + Kd * derivative;
-
-        //record the error to be used as the past error in the next call
-        previousError = error;
-
-        return output;
-    }
-};
-#endif
+#include "ControlScalar.h"
+
+#ifndef PID_CONTROLLER
+#define PID_CONTROLLER
+
+/// @brief PID controller on a scalar type, use PIDController for the control scalar of the build
+/// @tparam Scalar [float|double] type of the gains, state and signals
+template <typename Scalar>
+class PIDControllerT
+{
+private:
+    Scalar Kp, Ki, Kd;
+    Scalar previousError, integral;
+
+    //Time aware state
+    Scalar previousMeasurement, filteredDerivative;
+    bool hasPrevious;
+    Scalar integralLimit;           //Largest |Ki * integral| contribution, 0 = unbounded
+    Scalar derivativeFilterTime;    //[sec] low pass time constant on the derivative, 0 = unfiltered
+    Scalar outputMin, outputMax;
+    bool outputLimited;
+
+    //Settle detection
+    Scalar settleErrorBand, settleRateBand, settleDwell, settledTime;
+    Scalar errorRate;
+    bool settled;
+
+public:
+    /// @brief Class to calculate error signal using PID method
+    /// @param p [Scalar] Proportional Coefficient
+    /// @param i [Scalar] Integral Coefficient
+    /// @param d [Scalar] Derivative Coefficient
+    PIDControllerT(Scalar p, Scalar i, Scalar d) : Kp(p), Ki(i), Kd(d), previousError(0), integral(0),
+        previousMeasurement(0), filteredDerivative(0), hasPrevious(false),
+        integralLimit(0), derivativeFilterTime(0),
+        outputMin(0), outputMax(0), outputLimited(false),
+        settleErrorBand(0), settleRateBand(0), settleDwell(0), settledTime(0),
+        errorRate(0), settled(false) {}
+
+    /// @brief Change the coefficients without clearing the controller state
+    /// @param p [Scalar] Proportional Coefficient
+    /// @param i [Scalar] Integral Coefficient
+    /// @param d [Scalar] Derivative Coefficient
+    void setGains(Scalar p, Scalar i, Scalar d)
+    {
+        Kp = p;
+        Ki = i;
+        Kd = d;
+    }
+
+    /// @brief Clamp the output signal
+    /// @param min [Scalar] smallest output
+    /// @param max [Scalar] largest output
+    void setOutputLimits(Scalar min, Scalar max)
+    {
+        outputMin = min;
+        outputMax = max;
+        outputLimited = true;
+    }
+
+    /// @brief Bound the integral term
+    /// @param limit [Scalar] largest magnitude of Ki * integral, 0 for no bound
+    void setIntegralLimit(Scalar limit)
+    {
+        integralLimit = limit;
+    }
+
+    /// @brief Low pass filter the derivative term
+    /// @param timeConstant [sec] filter time constant, 0 for no filtering
+    void setDerivativeFilter(Scalar timeConstant)
+    {
+        derivativeFilterTime = timeConstant;
+    }
+
+    /// @brief Configure settle detection
+    /// @param errorBand [Scalar] largest |error| counted as settled
+    /// @param rateBand [Scalar] largest |error rate| per second counted as settled
+    /// @param dwell [sec] time both must hold before isSettled() reports true
+    void setSettleCriteria(Scalar errorBand, Scalar rateBand, Scalar dwell)
+    {
+        settleErrorBand = errorBand;
+        settleRateBand = rateBand;
+        settleDwell = dwell;
+    }
+
+    /// @brief Clear all accumulated state before a new motion
+    void reset()
+    {
+        previousError = 0;
+        integral = 0;
+        previousMeasurement = 0;
+        filteredDerivative = 0;
+        hasPrevious = false;
+        settledTime = 0;
+        errorRate = 0;
+        settled = false;
+    }
+
+    /// @brief Calculate a new control signal
+    /// @param error [Scalar] Measured error
+    /// @return [Scalar] Calculated control signal
+    Scalar calculateControlSignal(Scalar error)
+    {
+        //calculate the proportional value by applying the proportional coefficient to the error.
+        Scalar proportional = Kp * error;
+
+        //add the current error to the integral value.
+        integral += error;
+
+        //calculate the derivative value by comparing the current error to the past error
+        Scalar derivative = error - previousError;
+
+        //calculate the output by adding the proportional value to the integral (with coefficient) and adding the derivative (with coefficient) to the sum.
+        Scalar output = proportional + Ki * integral + Kd * derivative;
+
+        //record the error to be used as the past error in the next call
+        previousError = error;
+
+        return output;
+    }
+
+    /// @brief Calculate a new control signal for a sample taken dt seconds after the previous one
+    /// @param error [Scalar] setpoint - measurement
+    /// @param measurement [Scalar] process value, the derivative is taken on it so setpoint steps do not kick the output
+    /// @param dt [sec] time since the previous call
+    /// @return [Scalar] Calculated control signal, clamped to the output limits
+    Scalar calculateControlSignal(Scalar error, Scalar measurement, Scalar dt)
+    {
+        return update(error, measurement, dt, false);
+    }
+
+    /// @brief Calculate a new control signal with the derivative taken on the error, for a setpoint that moves
+    /// smoothly (a motion profile): on the measurement alone the derivative would brake against the setpoint motion
+    /// @param error [Scalar] setpoint - measurement
+    /// @param dt [sec] time since the previous call
+    /// @return [Scalar] Calculated control signal, clamped to the output limits
+    Scalar calculateControlSignal(Scalar error, Scalar dt)
+    {
+        return update(error, 0, dt, true);
+    }
+
+    /// @brief Has the error stayed inside the settle criteria for the dwell time
+    /// @return [bool] true when settled
+    bool isSettled()
+    {
+        return settled;
+    }
+
+private:
+    Scalar update(Scalar error, Scalar measurement, Scalar dt, bool derivativeOnError)
+    {
+        if (dt <= 0) dt = Scalar(1e-3);
+
+        Scalar proportional = Kp * error;
+
+        //derivative on measurement or on error, optionally low pass filtered
+        Scalar derivative = 0;
+        if (hasPrevious)
+        {
+            Scalar rawDerivative = derivativeOnError ? (error - previousError) / dt : -(measurement - previousMeasurement) / dt;
+            if (derivativeFilterTime > 0)
+                filteredDerivative += (rawDerivative - filteredDerivative) * (dt / (derivativeFilterTime + dt));
+            else
+                filteredDerivative = rawDerivative;
+            derivative = filteredDerivative;
+            //the settle rate goes through the same filter, sensor noise alone should not restart the dwell
+            Scalar rawRate = (error - previousError) / dt;
+            if (derivativeFilterTime > 0)
+                errorRate += (rawRate - errorRate) * (dt / (derivativeFilterTime + dt));
+            else
+                errorRate = rawRate;
+        }
+
+        //conditional integration: only integrate while the output is not pushing into a limit in the same direction
+        Scalar candidate = integral + error * dt;
+        Scalar unsaturated = proportional + Ki * candidate + Kd * derivative;
+        bool saturatedHigh = outputLimited && (unsaturated > outputMax) && (error > 0);
+        bool saturatedLow = outputLimited && (unsaturated < outputMin) && (error < 0);
+        if (!saturatedHigh && !saturatedLow) integral = candidate;
+        if ((integralLimit > 0) && (Ki != 0))
+        {
+            Scalar bound = integralLimit / ScalarAbs(Ki);
+            if (integral > bound) integral = bound;
+            if (integral < -bound) integral = -bound;
+        }
+
+        Scalar output = proportional + Ki * integral + Kd * derivative;
+        if (outputLimited)
+        {
+            if (output > outputMax) output = outputMax;
+            if (output < outputMin) output = outputMin;
+        }
+
+        //settle tracking, the dwell counts as met within half a sample: five float 0.02 sec samples add up to just under 0.1 sec
+        if ((ScalarAbs(error) <= settleErrorBand) && (!hasPrevious || (ScalarAbs(errorRate) <= settleRateBand)))
+            settledTime += dt;
+        else
+            settledTime = 0;
+        settled = (settledTime > 0) && ((settledTime + (dt / 2)) >= settleDwell);
+
+        previousError = error;
+        previousMeasurement = measurement;
+        hasPrevious = true;
+
+        return output;
+    }
+};
+
+typedef PIDControllerT<ControlScalar> PIDController;
+#endif
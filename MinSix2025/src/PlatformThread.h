@@ -0,0 +1,92 @@
+#include <stdint.h>
+#ifdef VexIQ2
+#include "vex.h"
+#else
+#include <thread>
+#include <chrono>
+#include <mutex>
+#endif
+
+#ifndef Platform_Thread
+#define Platform_Thread
+
+/// @brief Background task that runs on a vex::thread on the brain and a std::thread on the host.
+/// Tasks are started once and run for the life of the program.
+class PlatformTask
+{
+    private:
+#ifdef VexIQ2
+    vex::thread *_thread;
+#else
+    std::thread *_thread;
+#endif
+
+    public:
+    enum Priorities
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    PlatformTask() : _thread(0) {}
+
+    /// @brief Start the task
+    /// @param Entry [function] task body, called once with Arg
+    /// @param Arg [void*] argument handed to Entry
+    /// @param Priority [Priorities] scheduling priority on the brain, ignored on the host
+    /// @return [bool] false if the task was already started
+    bool Start(int (*Entry)(void *), void *Arg, Priorities Priority)
+    {
+        if (_thread != 0) return false;
+#ifdef VexIQ2
+        _thread = new vex::thread(Entry, Arg);
+        if (Priority == Low) _thread->setPriority(vex::thread::threadPriorityLow);
+        if (Priority == High) _thread->setPriority(vex::thread::threadPriorityHigh);
+#else
+        (void)Priority;
+        _thread = new std::thread(Entry, Arg);
+        _thread->detach();
+#endif
+        return true;
+    }
+
+    bool IsStarted()
+    {
+        return _thread != 0;
+    }
+};
+
+/// @brief Mutual exclusion between tasks, a vex::mutex on the brain and a std::mutex on the host
+class PlatformMutex
+{
+    private:
+#ifdef VexIQ2
+    vex::mutex _mutex;
+#else
+    std::mutex _mutex;
+#endif
+
+    public:
+    void Lock()
+    {
+        _mutex.lock();
+    }
+
+    void Unlock()
+    {
+        _mutex.unlock();
+    }
+};
+
+/// @brief Sleep the calling task in real time
+/// @param TimeMs [ms] time to sleep
+inline void PlatformSleepMs(uint32_t TimeMs)
+{
+#ifdef VexIQ2
+    vex::this_thread::sleep_for(TimeMs);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeMs));
+#endif
+}
+#endif
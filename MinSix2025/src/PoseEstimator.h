@@ -0,0 +1,117 @@
+#include "ControlScalar.h"
+#include <stdint.h>
+#include <atomic>
+
+#ifndef Pose_Estimator
+#define Pose_Estimator
+
+/// @brief Field position of the bot. Heading 0 drives along +Y, 90 along +X.
+struct Pose
+{
+    ControlScalar X;           //[mm]
+    ControlScalar Y;           //[mm]
+    ControlScalar Heading;     //[deg] 0-360, clockwise
+};
+
+/// @brief Dead reckoning from the drive encoders and the inertial rotation. Distance comes from the
+/// mean of the two encoder deltas, direction from the gyro, integrated at the midpoint heading of
+/// each step. One task writes it with Update(); any task may call Reset() and Get().
+class PoseEstimator
+{
+    private:
+    Pose _pose;
+    ControlScalar _mmPerMotorDeg;
+    ControlScalar _headingOffset;      //Pose heading - inertial rotation
+    ControlScalar _lastLeftPosition;
+    ControlScalar _lastRightPosition;
+    ControlScalar _lastRotation;
+    bool _primed;
+    std::atomic<uint32_t> _sequence;    //Odd while an update is being written
+    ControlScalar _resetX;
+    ControlScalar _resetY;
+    std::atomic<bool> _resetPending;    //Reset() is applied by the writer on its next Update()
+
+    static ControlScalar WrapHeading(ControlScalar Heading)
+    {
+        Heading = ScalarFmod(Heading, ControlScalar(360));
+        if (Heading < 0) Heading += ControlScalar(360);
+        return Heading;
+    }
+
+    public:
+    PoseEstimator() : _mmPerMotorDeg(0), _headingOffset(0), _lastLeftPosition(0), _lastRightPosition(0),
+        _lastRotation(0), _primed(false), _sequence(0), _resetX(0), _resetY(0), _resetPending(false)
+    {
+        _pose.X = 0;
+        _pose.Y = 0;
+        _pose.Heading = 0;
+    }
+
+    /// @brief Drive geometry
+    /// @param MmPerMotorDeg [mm/deg] wheel travel per degree of motor rotation
+    void SetGeometry(ControlScalar MmPerMotorDeg)
+    {
+        _mmPerMotorDeg = MmPerMotorDeg;
+    }
+
+    /// @brief Place the bot, taking effect on the next Update(). The heading keeps following the inertial sensor.
+    /// @param X [mm] field position
+    /// @param Y [mm] field position
+    void Reset(ControlScalar X, ControlScalar Y)
+    {
+        _resetX = X;
+        _resetY = Y;
+        _resetPending.store(true, std::memory_order_release);
+    }
+
+    /// @brief Integrate one step
+    /// @param LeftPosition [deg] left motor encoder
+    /// @param RightPosition [deg] right motor encoder
+    /// @param Rotation [deg] inertial rotation, not wrapped
+    /// @param Heading [deg] inertial heading, used to place the first step after a reset
+    void Update(ControlScalar LeftPosition, ControlScalar RightPosition, ControlScalar Rotation, ControlScalar Heading)
+    {
+        _sequence.fetch_add(1, std::memory_order_acq_rel);
+        if (_resetPending.load(std::memory_order_acquire))
+        {
+            _pose.X = _resetX;
+            _pose.Y = _resetY;
+            _resetPending.store(false, std::memory_order_relaxed);
+            _primed = false;
+        }
+        if (!_primed)
+        {
+            _headingOffset = Heading - Rotation;
+            _primed = true;
+        }
+        else
+        {
+            ControlScalar distance = (((LeftPosition - _lastLeftPosition) + (RightPosition - _lastRightPosition)) / ControlScalar(2)) * _mmPerMotorDeg;
+            ControlScalar midHeading = ScalarRadians(_headingOffset + ((Rotation + _lastRotation) / ControlScalar(2)));
+            _pose.X += distance * ScalarSin(midHeading);
+            _pose.Y += distance * ScalarCos(midHeading);
+        }
+        _pose.Heading = WrapHeading(_headingOffset + Rotation);
+        _lastLeftPosition = LeftPosition;
+        _lastRightPosition = RightPosition;
+        _lastRotation = Rotation;
+        _sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    /// @brief Consistent copy of the pose, safe to call from any task
+    /// @return [Pose] latest estimate
+    Pose Get()
+    {
+        Pose pose;
+        uint32_t before, after;
+        do
+        {
+            before = _sequence.load(std::memory_order_acquire);
+            pose = _pose;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || (before != after));
+        return pose;
+    }
+};
+#endif
@@ -0,0 +1,197 @@
+#include "ControlScalar.h"
+
+#ifndef Pure_Pursuit
+#define Pure_Pursuit
+
+/// @brief Field waypoint, same frame as Pose: heading 0 drives along +Y, 90 along +X
+struct PathPoint
+{
+    double X;       //[mm]
+    double Y;       //[mm]
+};
+
+/// @brief Output of one PurePursuit update
+template <typename Scalar>
+struct PursuitCommandT
+{
+    Scalar Curvature;   //[1/mm] signed, positive curves clockwise
+    Scalar Velocity;    //[mm/s] highest center speed allowed here
+    Scalar Remaining;   //[mm] path left from the closest point, <= 0 once the end is passed
+};
+
+/// @brief Pure pursuit over a polyline of waypoints. Each update steers toward the point one lookahead distance
+/// further along the path than the closest point, and limits the speed by the curvature of that steer, by the
+/// curvature at the waypoints ahead (so the bot slows before a corner) and by the distance left to the end.
+/// @tparam Scalar [float or double] arithmetic type, see ControlScalar
+template <typename Scalar>
+class PurePursuitT
+{
+    public:
+    static const int MaxPoints = 32;
+
+    private:
+    Scalar _x[MaxPoints];
+    Scalar _y[MaxPoints];
+    Scalar _distance[MaxPoints];    //[mm] path distance of each point from the start
+    Scalar _speedLimit[MaxPoints];  //[mm/s] highest speed at each point that can still brake for the rest of the path
+    int _count;
+    int _segment;                   //Segment holding the closest point, only moves forward
+    Scalar _progress;               //[mm] path distance of the closest point
+    Scalar _lookahead;
+    Scalar _halfTrack;
+    Scalar _maxVelocity;
+    Scalar _maxAcceleration;
+    Scalar _maxLateralAcceleration;
+
+    /// @brief Highest speed on a curvature: the outer wheel stays inside MaxVelocity, the sideways acceleration inside its limit
+    Scalar CurvatureSpeed(Scalar Curvature)
+    {
+        Scalar curvature = ScalarAbs(Curvature);
+        Scalar speed = _maxVelocity / (Scalar(1) + (curvature * _halfTrack));
+        if ((_maxLateralAcceleration > 0) && (curvature > 0))
+        {
+            Scalar lateral = ScalarSqrt(_maxLateralAcceleration / curvature);
+            if (lateral < speed) speed = lateral;
+        }
+        return speed;
+    }
+
+    /// @brief Point at a path distance, past the end the last segment is extended so the steer stays straight
+    void PointAt(Scalar Distance, Scalar &X, Scalar &Y)
+    {
+        int i = _segment;
+        while ((i < (_count - 2)) && (Distance > _distance[i + 1])) i++;
+        Scalar length = _distance[i + 1] - _distance[i];
+        Scalar t = (length > 0) ? (Distance - _distance[i]) / length : Scalar(1);
+        if ((t > 1) && (i < (_count - 2))) t = 1;
+        X = _x[i] + ((_x[i + 1] - _x[i]) * t);
+        Y = _y[i] + ((_y[i + 1] - _y[i]) * t);
+    }
+
+    public:
+    PurePursuitT() : _count(0), _segment(0), _progress(0), _lookahead(1), _halfTrack(0), _maxVelocity(0), _maxAcceleration(1), _maxLateralAcceleration(0) {}
+
+    /// @brief Set up a path from the bot's position through the waypoints
+    /// @param StartX [mm] bot position, the first point of the path
+    /// @param StartY [mm] bot position
+    /// @param Points [PathPoint*] waypoints, up to MaxPoints - 1 are used
+    /// @param Count [int] number of waypoints
+    /// @param Lookahead [mm] distance along the path to steer toward
+    /// @param TrackWidth [mm] wheel to wheel distance
+    /// @param MaxVelocity [mm/s] top wheel speed
+    /// @param MaxAcceleration [mm/s^2] braking limit used for corners and the end of the path
+    /// @param MaxLateralAcceleration [mm/s^2][Optional] sideways acceleration limit in curves, 0 for none
+    /// @return [bool] false if the path has no length
+    bool Plan(Scalar StartX, Scalar StartY, const PathPoint *Points, int Count, Scalar Lookahead, Scalar TrackWidth,
+              Scalar MaxVelocity, Scalar MaxAcceleration, Scalar MaxLateralAcceleration = 0)
+    {
+        _lookahead = (Lookahead > 1) ? Lookahead : Scalar(1);
+        _halfTrack = TrackWidth / Scalar(2);
+        _maxVelocity = MaxVelocity;
+        _maxAcceleration = (MaxAcceleration > 0) ? MaxAcceleration : Scalar(1);
+        _maxLateralAcceleration = MaxLateralAcceleration;
+        _segment = 0;
+        _progress = 0;
+
+        //Drop points on top of the previous one, they have no direction
+        _count = 1;
+        _x[0] = StartX;
+        _y[0] = StartY;
+        _distance[0] = 0;
+        for (int i = 0; (i < Count) && (_count < MaxPoints); i++)
+        {
+            Scalar dx = (Scalar)Points[i].X - _x[_count - 1];
+            Scalar dy = (Scalar)Points[i].Y - _y[_count - 1];
+            Scalar length = ScalarSqrt((dx * dx) + (dy * dy));
+            if (length < Scalar(1)) continue;
+            _x[_count] = (Scalar)Points[i].X;
+            _y[_count] = (Scalar)Points[i].Y;
+            _distance[_count] = _distance[_count - 1] + length;
+            _count++;
+        }
+        if (_count < 2) return false;
+
+        //Corner speeds from the circle through each point and its neighbours, then back from the end so every
+        //limit can be reached braking at MaxAcceleration
+        _speedLimit[0] = _maxVelocity;
+        _speedLimit[_count - 1] = 0;
+        for (int i = 1; i < (_count - 1); i++)
+        {
+            Scalar ax = _x[i] - _x[i - 1], ay = _y[i] - _y[i - 1];
+            Scalar bx = _x[i + 1] - _x[i], by = _y[i + 1] - _y[i];
+            Scalar cx = _x[i + 1] - _x[i - 1], cy = _y[i + 1] - _y[i - 1];
+            Scalar sides = ScalarSqrt(((ax * ax) + (ay * ay)) * ((bx * bx) + (by * by)) * ((cx * cx) + (cy * cy)));
+            Scalar curvature = (sides > 0) ? (Scalar(2) * ScalarAbs((ax * by) - (ay * bx))) / sides : Scalar(0);
+            _speedLimit[i] = CurvatureSpeed(curvature);
+        }
+        for (int i = _count - 2; i >= 0; i--)
+        {
+            Scalar reachable = ScalarSqrt((_speedLimit[i + 1] * _speedLimit[i + 1]) + (Scalar(2) * _maxAcceleration * (_distance[i + 1] - _distance[i])));
+            if (reachable < _speedLimit[i]) _speedLimit[i] = reachable;
+        }
+        return true;
+    }
+
+    /// @brief Steer and speed for the current pose
+    /// @param X [mm] bot position
+    /// @param Y [mm] bot position
+    /// @param Heading [deg] bot heading, clockwise from +Y
+    /// @return [PursuitCommand] curvature to drive, speed limit and the path left
+    PursuitCommandT<Scalar> Update(Scalar X, Scalar Y, Scalar Heading)
+    {
+        //Closest point, searched on the current and next segments so the progress never jumps back
+        Scalar best = -1;
+        int last = (_segment + 2 < (_count - 1)) ? (_segment + 2) : (_count - 2);
+        for (int i = _segment; i <= last; i++)
+        {
+            Scalar sx = _x[i + 1] - _x[i], sy = _y[i + 1] - _y[i];
+            Scalar length = _distance[i + 1] - _distance[i];
+            Scalar t = (((X - _x[i]) * sx) + ((Y - _y[i]) * sy)) / (length * length);
+            if (t < 0) t = 0;
+            if ((t > 1) && (i < (_count - 2))) t = 1;
+            Scalar px = _x[i] + (sx * t) - X, py = _y[i] + (sy * t) - Y;
+            Scalar gap = (px * px) + (py * py);
+            if ((best < 0) || (gap < best))
+            {
+                best = gap;
+                Scalar progress = _distance[i] + (length * t);
+                if (progress >= _progress)
+                {
+                    _segment = i;
+                    _progress = progress;
+                }
+            }
+        }
+
+        //Steer on the arc through the lookahead point, tangent to the heading: curvature = 2 * sideways offset / distance^2
+        Scalar lx, ly;
+        PointAt(_progress + _lookahead, lx, ly);
+        Scalar dx = lx - X, dy = ly - Y;
+        Scalar radians = ScalarRadians(Heading);
+        Scalar right = (dx * ScalarCos(radians)) - (dy * ScalarSin(radians));
+        Scalar squared = (dx * dx) + (dy * dy);
+
+        PursuitCommandT<Scalar> command;
+        command.Curvature = (squared > 1) ? (Scalar(2) * right) / squared : Scalar(0);
+        command.Remaining = _distance[_count - 1] - _progress;
+
+        //Slowest of: the steer, braking for the next point's limit and braking for the end
+        Scalar speed = CurvatureSpeed(command.Curvature);
+        Scalar toNext = _distance[_segment + 1] - _progress;
+        if (toNext < 0) toNext = 0;
+        Scalar next = ScalarSqrt((_speedLimit[_segment + 1] * _speedLimit[_segment + 1]) + (Scalar(2) * _maxAcceleration * toNext));
+        if (next < speed) speed = next;
+        command.Velocity = speed;
+        return command;
+    }
+
+    /// @return [mm] length of the planned path
+    Scalar GET_Length()
+    {
+        return (_count > 0) ? _distance[_count - 1] : Scalar(0);
+    }
+};
+
+typedef PursuitCommandT<ControlScalar> PursuitCommand;
+typedef PurePursuitT<ControlScalar> PurePursuit;
+#endif
@@ -0,0 +1,112 @@
+#include "DriveTrigger.h"
+#include "PurePursuit.h"
+
+#ifndef Routine_Table
+#define Routine_Table
+
+/// @brief One step of a routine table run by Min6AutoDrivetrain::RunRoutine.
+/// Build steps with TurnStep, DriveStep, DriveUntilStep, ArcStep, PathStep, WaitStep and WaitUntilStep.
+struct RoutineStep
+{
+    enum Kinds
+    {
+        Turn,
+        Drive,
+        DriveUntil,
+        Arc,
+        Path,
+        Wait,
+        WaitUntil
+    };
+    Kinds Kind;
+    double Value;           //[deg] heading, [mm] distance, [mm] longest DriveUntil distance, [deg] arc angle, [mm] path lookahead or [sec] wait time
+    double Velocity;        //[RPM] top motor velocity
+    double TimeOut;         //[sec] time allotted to the step
+    double Tolerance;       //[deg] turn heading tolerance
+    int AccertionSteps;     //Control periods used to bring motors up to speed
+    bool (*Condition)();    //WaitUntil: the step ends once this returns true
+    DriveTrigger Trigger;   //DriveUntil: sensor condition that ends the drive
+    double Radius;          //Arc: [mm] turning radius of the bot center
+    const PathPoint *Points;    //Path: waypoints in the ResetPose frame
+    int PointCount;             //Path: number of waypoints
+};
+
+/// @brief A named routine: a table of steps run in order
+struct RoutineTable
+{
+    const char *Name;
+    const RoutineStep *Steps;
+    int StepCount;
+};
+
+/// @brief Step with every field given: no condition, trigger, radius or waypoints. The factories below start from it.
+inline RoutineStep MakeRoutineStep(RoutineStep::Kinds Kind, double Value, double Velocity, double TimeOut, double Tolerance, int AccertionSteps)
+{
+    RoutineStep step;
+    step.Kind = Kind;
+    step.Value = Value;
+    step.Velocity = Velocity;
+    step.TimeOut = TimeOut;
+    step.Tolerance = Tolerance;
+    step.AccertionSteps = AccertionSteps;
+    step.Condition = 0;
+    step.Trigger = DriveTrigger();
+    step.Radius = 0;
+    step.Points = 0;
+    step.PointCount = 0;
+    return step;
+}
+
+/// @brief Turn to a heading, see TurnToHeading
+inline RoutineStep TurnStep(double Heading, double TurnVelocity, double TimeOut, double HeadingTolerance, int AccertionSteps = 10)
+{
+    return MakeRoutineStep(RoutineStep::Turn, Heading, TurnVelocity, TimeOut, HeadingTolerance, AccertionSteps);
+}
+
+/// @brief Drive straight, see DriveDistance. Consecutive drives in the same direction are chained without stopping.
+inline RoutineStep DriveStep(double Distance, double DriveVelocity, double TimeOut, int AccertionSteps = 10)
+{
+    return MakeRoutineStep(RoutineStep::Drive, Distance, DriveVelocity, TimeOut, 0, AccertionSteps);
+}
+
+/// @brief Drive straight until a sensor condition fires, see DriveUntil. A drive before it in the same direction
+/// hands over its speed.
+inline RoutineStep DriveUntilStep(const DriveTrigger &Trigger, double MaxDistance, double DriveVelocity, double TimeOut, int AccertionSteps = 10)
+{
+    RoutineStep step = MakeRoutineStep(RoutineStep::DriveUntil, MaxDistance, DriveVelocity, TimeOut, 0, AccertionSteps);
+    step.Trigger = Trigger;
+    return step;
+}
+
+/// @brief Drive forward on an arc, see ArcTurn. Drives and arcs before and after it in the same direction are chained
+/// without stopping.
+inline RoutineStep ArcStep(double Radius, double Angle, double DriveVelocity, double TimeOut, int AccertionSteps = 10)
+{
+    RoutineStep step = MakeRoutineStep(RoutineStep::Arc, Angle, DriveVelocity, TimeOut, 0, AccertionSteps);
+    step.Radius = Radius;
+    return step;
+}
+
+/// @brief Follow waypoints, see FollowPath. The waypoint table must outlive the routine.
+inline RoutineStep PathStep(const PathPoint *Points, int Count, double DriveVelocity, double Lookahead, double TimeOut, int AccertionSteps = 10)
+{
+    RoutineStep step = MakeRoutineStep(RoutineStep::Path, Lookahead, DriveVelocity, TimeOut, 0, AccertionSteps);
+    step.Points = Points;
+    step.PointCount = Count;
+    return step;
+}
+
+/// @brief Hold still for a time
+inline RoutineStep WaitStep(double TimeSec)
+{
+    return MakeRoutineStep(RoutineStep::Wait, TimeSec, 0, TimeSec, 0, 0);
+}
+
+/// @brief Hold still until a condition is true or the time out passes
+inline RoutineStep WaitUntilStep(bool (*Condition)(), double TimeOut)
+{
+    RoutineStep step = MakeRoutineStep(RoutineStep::WaitUntil, 0, 0, TimeOut, 0, 0);
+    step.Condition = Condition;
+    return step;
+}
+#endif
@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "DrivetrainHardware.h"
+#include "PlatformThread.h"
+
+#ifndef Status_Display
+#define Status_Display
+
+/// @brief Bot status on the brain screen and touch LEDs. Any task writes rows and LED colours into a small
+/// frame in constant time; a low priority task copies the frame at a throttled rate and draws only what changed,
+/// so screen and LED I/O never runs on a motion or control task.
+class StatusDisplay
+{
+    public:
+        static const int Rows = 5;          //Screen rows used, 1 based like IBrainHardware
+        static const int Columns = 26;      //Characters kept per row
+        static const int MaxLeds = 4;
+
+    private:
+        struct Frame
+        {
+            char Text[Rows][Columns + 1];
+            int8_t Led[MaxLeds];            //IStatusLed::Colors, -1 never set
+        };
+
+        IBrainHardware &m_Brain;
+        IStatusLed *m_Leds[MaxLeds];
+        PlatformMutex _lock;
+        Frame _frame;                       //Written by any task under _lock
+        uint32_t _version;                  //Bumped by every write under _lock
+        Frame _shown;                       //What the render task last drew
+        uint32_t _shownVersion;
+        uint32_t _renderPeriodMs;
+        PlatformTask _renderTask;
+
+        /// @brief Body of the render task
+        static int RenderTaskEntry(void *Arg)
+        {
+            StatusDisplay *display = (StatusDisplay *)Arg;
+            while (true)
+            {
+                display->Render();
+                PlatformSleepMs(display->_renderPeriodMs);
+            }
+            return 0;
+        }
+
+    public:
+        /// @param Brain [IBrainHardware] screen to draw on
+        StatusDisplay(IBrainHardware &Brain) : m_Brain(Brain), _version(0), _shownVersion(0), _renderPeriodMs(100)
+        {
+            for (int i = 0; i < MaxLeds; i++) m_Leds[i] = 0;
+            memset(&_frame, 0, sizeof(_frame));
+            memset(&_frame.Led, -1, sizeof(_frame.Led));
+            _shown = _frame;
+        }
+
+        /// @brief Attach a touch LED to a slot, before Start
+        /// @param Slot [int] 0 to MaxLeds - 1, used by SetLed
+        /// @param Led [IStatusLed] LED, must outlive the display
+        void Set_LED(int Slot, IStatusLed &Led)
+        {
+            if ((Slot >= 0) && (Slot < MaxLeds)) m_Leds[Slot] = &Led;
+        }
+
+        /// @brief Start the low priority render task
+        /// @param RenderPeriodMs [ms][Optional default value is 100] time between redraws
+        void Start(uint32_t RenderPeriodMs = 100)
+        {
+            _renderPeriodMs = RenderPeriodMs;
+            _renderTask.Start(RenderTaskEntry, this, PlatformTask::Low);
+        }
+
+        /// @brief Set the text of a screen row, cut to Columns characters
+        /// @param Row [int] screen row, 1 based
+        /// @param Format [char*] printf format
+        void SetRow(int Row, const char *Format, ...)
+        {
+            if ((Row < 1) || (Row > Rows)) return;
+            char text[Columns + 1];
+            va_list args;
+            va_start(args, Format);
+            vsnprintf(text, sizeof(text), Format, args);
+            va_end(args);
+            _lock.Lock();
+            memcpy(_frame.Text[Row - 1], text, sizeof(text));
+            _version++;
+            _lock.Unlock();
+        }
+
+        /// @brief Blank a screen row
+        /// @param Row [int] screen row, 1 based
+        void ClearRow(int Row)
+        {
+            if ((Row < 1) || (Row > Rows)) return;
+            _lock.Lock();
+            _frame.Text[Row - 1][0] = 0;
+            _version++;
+            _lock.Unlock();
+        }
+
+        /// @brief Set the colour of a touch LED
+        /// @param Slot [int] slot given to Set_LED
+        /// @param Color [IStatusLed::Colors] new colour
+        void SetLed(int Slot, IStatusLed::Colors Color)
+        {
+            if ((Slot < 0) || (Slot >= MaxLeds)) return;
+            _lock.Lock();
+            _frame.Led[Slot] = (int8_t)Color;
+            _version++;
+            _lock.Unlock();
+        }
+
+        /// @brief Draw the rows and LEDs that changed since the last call. Run by the render task, or
+        /// called directly before it is started.
+        void Render()
+        {
+            Frame frame;
+            _lock.Lock();
+            bool Changed = (_version != _shownVersion);
+            if (Changed) frame = _frame;
+            _shownVersion = _version;
+            _lock.Unlock();
+            if (!Changed) return;
+
+            for (int r = 0; r < Rows; r++)
+            {
+                if (strcmp(frame.Text[r], _shown.Text[r]) == 0) continue;
+                m_Brain.ScreenClearLine(r + 1);
+                if (frame.Text[r][0] != 0) m_Brain.ScreenPrintAt(r + 1, 1, frame.Text[r]);
+            }
+            for (int i = 0; i < MaxLeds; i++)
+            {
+                if ((m_Leds[i] != 0) && (frame.Led[i] >= 0) && (frame.Led[i] != _shown.Led[i]))
+                    m_Leds[i]->SetColor((IStatusLed::Colors)frame.Led[i]);
+            }
+            _shown = frame;
+        }
+};
+#endif
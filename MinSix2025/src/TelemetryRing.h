@@ -0,0 +1,86 @@
+#include <stdint.h>
+#include <atomic>
+
+#ifndef Telemetry_Ring
+#define Telemetry_Ring
+
+/// @brief One control tick of a motion, 32 bytes
+struct TelemetryRecord
+{
+    uint32_t TimeUs;        //[us] since the motion started
+    uint16_t Motion;        //Motion sequence number, changes between motion commands
+    uint16_t Flags;         //TelemetryFlags
+    float Target;           //[deg] requested heading
+    float CommandRPM;       //Requested motor velocity
+    float RightRPM;         //Measured right motor velocity
+    float LeftRPM;          //Measured left motor velocity
+    float Heading;          //[deg] inertial heading
+    float Rotation;         //[deg] inertial rotation since the motion started
+};
+
+enum TelemetryFlags
+{
+    TelemetryOverrun = 0x0001,  //The tick started after its deadline
+    TelemetryTurn = 0x0002,     //Tick of a TurnToHeading
+    TelemetryDrive = 0x0004     //Tick of a DriveDistance
+};
+
+/// @brief Fixed size lock free ring for a single producer (the control loop) and a single
+/// consumer (the drain task or a post-run dump). Pushing never blocks; when the ring is
+/// full the new record is dropped and counted.
+/// @tparam Capacity [int] number of records, must be a power of two
+template <int Capacity>
+class TelemetryRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "TelemetryRing Capacity must be a power of two");
+
+    private:
+    TelemetryRecord _records[Capacity];
+    std::atomic<uint32_t> _head;        //Next slot to write, owned by the producer
+    std::atomic<uint32_t> _tail;        //Next slot to read, owned by the consumer
+    std::atomic<uint32_t> _dropped;
+
+    public:
+    TelemetryRing() : _head(0), _tail(0), _dropped(0) {}
+
+    /// @brief Store a record
+    /// @param Record [TelemetryRecord] record to copy into the ring
+    /// @return [bool] false if the ring was full and the record was dropped
+    bool Push(const TelemetryRecord &Record)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if ((head - _tail.load(std::memory_order_acquire)) >= (uint32_t)Capacity)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _records[head & (Capacity - 1)] = Record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Take the oldest record
+    /// @param Record [TelemetryRecord] receives the record
+    /// @return [bool] false if the ring was empty
+    bool Pop(TelemetryRecord &Record)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        Record = _records[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @return [int] records waiting to be read
+    int GET_Count()
+    {
+        return (int)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+    }
+
+    /// @return [int] records dropped because the ring was full
+    int GET_Dropped()
+    {
+        return (int)_dropped.load(std::memory_order_relaxed);
+    }
+};
+#endif
@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "DrivetrainHardware.h"
+#include "MotionAccelerator.h"
+#include "MotionProfile.h"
+#include "PIDController.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+
+#ifndef Tick_Benchmark
+#define Tick_Benchmark
+
+/// @brief Cost of one benchmark kernel
+struct TickBenchmarkResult
+{
+    const char *Name;
+    uint32_t Ticks;         //Calls timed per run
+    double NsPerTick;       //Best of the runs, other tasks can only make a run slower
+    double TicksPerSec;
+};
+
+/// @brief Stored cost of a kernel to compare a new run against, NsPerTick 0 = not measured yet
+struct TickBenchmarkBaseline
+{
+    const char *Name;
+    double NsPerTick;
+};
+
+/// @brief Zero cost drivetrain hardware on a virtual clock for timing whole control ticks.
+/// Sleeps only advance the clock, the gyro follows the motor commands exactly.
+class TickBenchmarkPlant : public IBrainHardware, public IInertialSensor
+{
+    public:
+        /// @brief Motor that reports back what it was commanded
+        class Motor : public IDriveMotor
+        {
+            public:
+                double CommandRPM;
+                double PositionDeg;
+
+                Motor() : CommandRPM(0), PositionDeg(0) {}
+                void Spin(double VelocityRPM) { CommandRPM = VelocityRPM; }
+                void Stop() { CommandRPM = 0; }
+                double Velocity() { return CommandRPM; }
+                double Position() { return PositionDeg; }
+                void ResetPosition() { PositionDeg = 0; }
+        };
+
+        Motor Left;
+        Motor Right;
+        uint32_t Ticks;         //Control loop waits since the last ResetTicks
+
+    private:
+        uint64_t _nowUs;
+        uint64_t _timerStartUs;
+        double _rotation;
+        double _degPerMotorDeg;
+
+        void Advance(uint64_t Us)
+        {
+            double sec = Us / 1000000.0;
+            Left.PositionDeg += Left.CommandRPM * 6.0 * sec;
+            Right.PositionDeg += Right.CommandRPM * 6.0 * sec;
+            _rotation += (Left.CommandRPM - Right.CommandRPM) * 3.0 * sec * _degPerMotorDeg;
+            _nowUs += Us;
+        }
+
+    public:
+        /// @param DegPerMotorDeg [deg] bot rotation per motor degree with the sides turning opposite ways
+        TickBenchmarkPlant(double DegPerMotorDeg) : Ticks(0), _nowUs(0), _timerStartUs(0), _rotation(0), _degPerMotorDeg(DegPerMotorDeg) {}
+
+        void ResetTicks() { Ticks = 0; }
+
+        uint64_t SystemTimeUs() { return _nowUs; }
+        void ResetTimer() { _timerStartUs = _nowUs; }
+        double TimerSec() { return (_nowUs - _timerStartUs) / 1000000.0; }
+        void SleepMs(uint32_t TimeMs) { Advance((uint64_t)TimeMs * 1000); }
+        void SleepUntilUs(uint64_t DeadlineUs)
+        {
+            Ticks++;
+            if (DeadlineUs > _nowUs) Advance(DeadlineUs - _nowUs);
+        }
+        void ScreenClear() {}
+        void ScreenClearLine(int Row) { (void)Row; }
+        void ScreenPrintAt(int Row, int Column, const char *Text) { (void)Row; (void)Column; (void)Text; }
+        double BatteryVoltage() { return 0; }
+
+        void Calibrate() {}
+        bool IsCalibrating() { return false; }
+        double Heading()
+        {
+            double heading = fmod(_rotation, 360.0);
+            return (heading < 0) ? heading + 360.0 : heading;
+        }
+        double Rotation() { return _rotation; }
+};
+
+/// @brief Per tick CPU cost of the controller kernels. Timed with the brain system timer so the same
+/// kernels run natively on the host and on the brain.
+class TickBenchmark
+{
+    public:
+        static const int KernelCount = 6;
+
+    private:
+        IBrainHardware &m_Clock;
+        TickBenchmarkResult _results[KernelCount];
+        int _resultCount;
+        static const int InputCount = 64;
+        ControlScalar _inputs[InputCount];  //Turn errors the kernels cycle through so no call can be folded away
+        volatile ControlScalar _sink;
+        TickBenchmarkPlant _plant;
+        Min6AutoDrivetrain _drivetrain;     //Built from gMinSixConfig like main.cpp, runs on _plant
+        LoopProfiler _profiler;             //Attached for the ProfiledTurnTick kernel, timed on the real clock
+        int _nextHeading;
+
+        void Record(const char *Name, uint32_t Ticks, double NsPerTick)
+        {
+            TickBenchmarkResult &result = _results[_resultCount++];
+            result.Name = Name;
+            result.Ticks = Ticks;
+            result.NsPerTick = NsPerTick;
+            result.TicksPerSec = (NsPerTick > 0) ? 1e9 / NsPerTick : 0;
+        }
+
+        uint64_t TimeAccelerator(uint32_t Ticks)
+        {
+            MotionAccelerator accelerator(Ticks / 3, Ticks / 3, Ticks - 2 * (Ticks / 3), ControlScalar(110), ControlScalar(5));
+            ControlScalar sum = 0;
+            uint64_t start = m_Clock.SystemTimeUs();
+            for (uint32_t i = 0; i < Ticks; i++) sum += accelerator.GetNextStepRPM();
+            uint64_t elapsed = m_Clock.SystemTimeUs() - start;
+            _sink = sum;
+            return elapsed;
+        }
+
+        uint64_t TimePID(uint32_t Ticks)
+        {
+            //Configured the way TurnSegment sets it up
+            PIDController pid(ControlScalar(1), ControlScalar(0), ControlScalar(0.1));
+            pid.setOutputLimits(-50, 50);
+            pid.setIntegralLimit(ControlScalar(12.5));
+            pid.setDerivativeFilter(ControlScalar(0.04));
+            pid.setSettleCriteria(ControlScalar(0.5), ControlScalar(2), ControlScalar(0.1));
+            ControlScalar sum = 0;
+            uint64_t start = m_Clock.SystemTimeUs();
+            for (uint32_t i = 0; i < Ticks; i++)
+            {
+                ControlScalar error = _inputs[i & (InputCount - 1)];
+                sum += pid.calculateControlSignal(error, ControlScalar(0.02));
+            }
+            uint64_t elapsed = m_Clock.SystemTimeUs() - start;
+            _sink = sum;
+            return elapsed;
+        }
+
+        uint64_t TimeHeadingError(uint32_t Ticks)
+        {
+            ControlScalar sum = 0;
+            uint64_t start = m_Clock.SystemTimeUs();
+            for (uint32_t i = 0; i < Ticks; i++)
+                sum += Min6AutoDrivetrain::HeadingError(_inputs[i & (InputCount - 1)] * ControlScalar(4), _inputs[(i + 17) & (InputCount - 1)] * ControlScalar(3));
+            uint64_t elapsed = m_Clock.SystemTimeUs() - start;
+            _sink = sum;
+            return elapsed;
+        }
+
+        uint64_t TimeProfile(uint32_t Ticks)
+        {
+            //The turn loop samples twice a tick: the setpoint and the feedforward one tick ahead
+            MotionProfile profile;
+            profile.Plan(ControlScalar(90), ControlScalar(260), ControlScalar(1300), 0);
+            ControlScalar step = profile.GET_Duration() / ControlScalar(256);
+            ControlScalar sum = 0;
+            uint64_t start = m_Clock.SystemTimeUs();
+            for (uint32_t i = 0; i < Ticks; i++)
+            {
+                ProfileState state = profile.Sample((i & 255) * step);
+                sum += state.Position + state.Velocity + state.Acceleration;
+            }
+            uint64_t elapsed = m_Clock.SystemTimeUs() - start;
+            _sink = sum;
+            return elapsed;
+        }
+
+        /// @brief Whole TurnToHeading ticks: sensor snapshot, profile, feedforward, PID, kick and motor write
+        uint64_t TimeTurnTick(uint32_t Ticks, uint32_t &Measured)
+        {
+            static const double Headings[] = {90.0, 270.0, 45.0, 0.0};
+            _plant.ResetTicks();
+            uint64_t start = m_Clock.SystemTimeUs();
+            while (_plant.Ticks < Ticks)
+            {
+                _drivetrain.TurnToHeading(Headings[_nextHeading], 50.0, 5.0, 0.5);
+                _nextHeading = (_nextHeading + 1) & 3;
+            }
+            uint64_t elapsed = m_Clock.SystemTimeUs() - start;
+            Measured = _plant.Ticks;
+            return elapsed;
+        }
+
+        /// @brief TurnTick with a loop profiler attached: the cost of the instrumentation is the difference
+        uint64_t TimeProfiledTurnTick(uint32_t Ticks, uint32_t &Measured)
+        {
+            _profiler.Reset();
+            _drivetrain.Set_LOOP_PROFILER(&_profiler);
+            uint64_t elapsed = TimeTurnTick(Ticks, Measured);
+            _drivetrain.Set_LOOP_PROFILER(0);
+            return elapsed;
+        }
+
+    public:
+        /// @param Clock [IBrainHardware] time source, the brain itself on the brain
+        TickBenchmark(IBrainHardware &Clock) :
+        m_Clock(Clock),
+        _resultCount(0),
+        _sink(0),
+        _plant(gMinSixConfig.MmPerMotorDeg() * 360.0 / (gMinSixConfig.TrackWidth * M_PI)),
+        _drivetrain(_plant, _plant, _plant.Right, _plant.Left, gMinSixConfig),
+        _profiler(Clock),
+        _nextHeading(0)
+        {
+            for (int i = 0; i < InputCount; i++) _inputs[i] = (ControlScalar)(60.0 * sin(i * 0.37) + 3.0 * cos(i * 2.1));
+            _drivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::None);
+            _drivetrain.Set_TURN_PID(1.0, 0.0, 0.1);
+            _drivetrain.Set_TURN_FEEDFORWARD(5.0, 0.0, 0.016);
+        }
+
+        /// @brief Time every kernel
+        /// @param Ticks [int] calls per run, the whole tick kernel runs Ticks / 100 control ticks
+        /// @param Runs [int] runs per kernel, the fastest is kept
+        void Run(uint32_t Ticks = 100000, int Runs = 5)
+        {
+            double best[KernelCount];
+            uint32_t turnTicks = Ticks / 100;
+            if (turnTicks < 50) turnTicks = 50;
+            uint32_t turnMeasured = turnTicks;
+            uint32_t profiledMeasured = turnTicks;
+            for (int run = 0; run < Runs; run++)
+            {
+                //Turns finish whole, so the tick kernel measures a few more ticks than asked for
+                double ns[KernelCount];
+                ns[0] = TimeAccelerator(Ticks) * 1000.0 / Ticks;
+                ns[1] = TimePID(Ticks) * 1000.0 / Ticks;
+                ns[2] = TimeHeadingError(Ticks) * 1000.0 / Ticks;
+                ns[3] = TimeProfile(Ticks) * 1000.0 / Ticks;
+                ns[4] = TimeTurnTick(turnTicks, turnMeasured) * 1000.0 / turnMeasured;
+                ns[5] = TimeProfiledTurnTick(turnTicks, profiledMeasured) * 1000.0 / profiledMeasured;
+                for (int k = 0; k < KernelCount; k++)
+                    if ((run == 0) || (ns[k] < best[k])) best[k] = ns[k];
+            }
+            _resultCount = 0;
+            Record("MotionAccelerator", Ticks, best[0]);
+            Record("PIDController", Ticks, best[1]);
+            Record("HeadingError", Ticks, best[2]);
+            Record("MotionProfile", Ticks, best[3]);
+            Record("TurnTick", turnMeasured, best[4]);
+            Record("ProfiledTurnTick", profiledMeasured, best[5]);
+        }
+
+        /// @return [int] number of results from the last Run
+        int GET_ResultCount()
+        {
+            return _resultCount;
+        }
+
+        /// @param Index [int] 0 to GET_ResultCount() - 1
+        const TickBenchmarkResult &GET_Result(int Index)
+        {
+            return _results[Index];
+        }
+
+        /// @brief Print the results, compared against baselines when there are any
+        /// @param Baselines [TickBenchmarkBaseline*] stored costs, matched by name, may be 0
+        /// @param BaselineCount [int] entries in Baselines
+        /// @param Tolerance [fraction] slowdown over the baseline reported as a regression
+        /// @return [int] number of kernels flagged as regressions
+        int Report(const TickBenchmarkBaseline *Baselines, int BaselineCount, double Tolerance)
+        {
+            int regressions = 0;
+            printf("%-18s %12s %14s %12s %9s\n", "Kernel", "ns/tick", "ticks/sec", "baseline", "change");
+            for (int r = 0; r < _resultCount; r++)
+            {
+                const TickBenchmarkResult &result = _results[r];
+                double baseline = 0;
+                for (int b = 0; b < BaselineCount; b++)
+                    if (strcmp(Baselines[b].Name, result.Name) == 0) baseline = Baselines[b].NsPerTick;
+                printf("%-18s %12.1f %14.0f", result.Name, result.NsPerTick, result.TicksPerSec);
+                if (baseline <= 0)
+                {
+                    printf(" %12s\n", "-");
+                    continue;
+                }
+                double change = (result.NsPerTick / baseline) - 1.0;
+                bool regressed = change > Tolerance;
+                if (regressed) regressions++;
+                printf(" %12.1f %+8.1f%%%s\n", baseline, change * 100.0, regressed ? "  REGRESSION" : "");
+            }
+            return regressions;
+        }
+
+        /// @brief Print the phase breakdown of the last ProfiledTurnTick run
+        void PrintLoopProfile()
+        {
+            _profiler.Dump();
+        }
+
+        /// @brief Print the results as a baseline table to paste into the source
+        void PrintBaselineTable()
+        {
+            printf("const TickBenchmarkBaseline gTickBaselines[] =\n{\n");
+            for (int r = 0; r < _resultCount; r++)
+                printf("    {\"%s\", %.1f}%s\n", _results[r].Name, _results[r].NsPerTick, (r + 1 < _resultCount) ? "," : "");
+            printf("};\n");
+        }
+};
+#endif
@@ -0,0 +1,213 @@
+#include "vex.h"
+#include "DrivetrainHardware.h"
+
+#ifndef Vex_Hardware
+#define Vex_Hardware
+
+/// @brief IDriveMotor backed by a VEX IQ smart motor
+class VexDriveMotor : public IDriveMotor
+{
+    private:
+        vex::motor &m_Motor;
+
+    public:
+        VexDriveMotor(vex::motor &Motor) : m_Motor(Motor) {}
+
+        void Spin(double VelocityRPM)
+        {
+            m_Motor.spin(vex::directionType::fwd, VelocityRPM, vex::velocityUnits::rpm);
+        }
+
+        void Stop()
+        {
+            m_Motor.stop();
+        }
+
+        double Velocity()
+        {
+            return m_Motor.velocity(vex::velocityUnits::rpm);
+        }
+
+        double Position()
+        {
+            return m_Motor.position(vex::rotationUnits::deg);
+        }
+
+        void ResetPosition()
+        {
+            m_Motor.resetPosition();
+        }
+};
+
+/// @brief IInertialSensor backed by the IQ2 brain inertial sensor
+class VexInertialSensor : public IInertialSensor
+{
+    private:
+        vex::inertial &m_Inertial;
+
+    public:
+        VexInertialSensor(vex::inertial &Inertial) : m_Inertial(Inertial) {}
+
+        void Calibrate()
+        {
+            m_Inertial.calibrate();
+        }
+
+        bool IsCalibrating()
+        {
+            return m_Inertial.isCalibrating();
+        }
+
+        double Heading()
+        {
+            return m_Inertial.heading(vex::rotationUnits::deg);
+        }
+
+        double Rotation()
+        {
+            return m_Inertial.rotation(vex::rotationUnits::deg);
+        }
+};
+
+/// @brief IDistanceSensor backed by a VEX IQ2 distance sensor
+class VexDistanceSensor : public IDistanceSensor
+{
+    private:
+        vex::distance &m_Distance;
+
+    public:
+        VexDistanceSensor(vex::distance &Distance) : m_Distance(Distance) {}
+
+        bool ObjectDetected()
+        {
+            return m_Distance.isObjectDetected();
+        }
+
+        double ObjectDistanceMm()
+        {
+            return m_Distance.objectDistance(vex::distanceUnits::mm);
+        }
+};
+
+/// @brief IOpticalSensor backed by a VEX IQ2 optical sensor
+class VexOpticalSensor : public IOpticalSensor
+{
+    private:
+        vex::optical &m_Optical;
+
+    public:
+        VexOpticalSensor(vex::optical &Optical) : m_Optical(Optical) {}
+
+        double Hue()
+        {
+            return m_Optical.hue();
+        }
+
+        double Brightness()
+        {
+            return m_Optical.brightness();
+        }
+};
+
+/// @brief IStatusLed backed by a VEX IQ touch LED
+class VexTouchLed : public IStatusLed
+{
+    private:
+        vex::touchled &m_Led;
+
+    public:
+        VexTouchLed(vex::touchled &Led) : m_Led(Led) {}
+
+        void SetColor(Colors Color)
+        {
+            switch (Color)
+            {
+                case White:
+                    m_Led.setColor(vex::colorType::white);
+                    break;
+                case Red:
+                    m_Led.setColor(vex::colorType::red);
+                    break;
+                case Green:
+                    m_Led.setColor(vex::colorType::green);
+                    break;
+                case Blue:
+                    m_Led.setColor(vex::colorType::blue);
+                    break;
+                case Orange:
+                    m_Led.setColor(vex::colorType::orange);
+                    break;
+                case Purple:
+                    m_Led.setColor(vex::colorType::purple);
+                    break;
+                case Yellow:
+                    m_Led.setColor(vex::colorType::yellow);
+                    break;
+                default:
+                    m_Led.setColor(vex::colorType::none);
+                    break;
+            }
+        }
+};
+
+/// @brief IBrainHardware backed by the IQ2 brain
+class VexBrainHardware : public IBrainHardware
+{
+    private:
+        vex::brain &m_Brain;
+
+    public:
+        VexBrainHardware(vex::brain &Brain) : m_Brain(Brain) {}
+
+        uint64_t SystemTimeUs()
+        {
+            return vex::timer::systemHighResolution();
+        }
+
+        void ResetTimer()
+        {
+            m_Brain.Timer.reset();
+        }
+
+        double TimerSec()
+        {
+            return m_Brain.Timer.time(vex::timeUnits::sec);
+        }
+
+        void SleepMs(uint32_t TimeMs)
+        {
+            vex::this_thread::sleep_for(TimeMs);
+        }
+
+        void SleepUntilUs(uint64_t DeadlineUs)
+        {
+            //Sleep whole milliseconds, then yield away the remainder
+            uint64_t now = SystemTimeUs();
+            if (DeadlineUs > (now + 1000))
+                vex::this_thread::sleep_for((uint32_t)((DeadlineUs - now) / 1000));
+            while (SystemTimeUs() < DeadlineUs)
+                vex::this_thread::yield();
+        }
+
+        void ScreenClear()
+        {
+            m_Brain.Screen.clearScreen();
+        }
+
+        void ScreenClearLine(int Row)
+        {
+            m_Brain.Screen.clearLine(Row);
+        }
+
+        void ScreenPrintAt(int Row, int Column, const char *Text)
+        {
+            m_Brain.Screen.setCursor(Row, Column);
+            m_Brain.Screen.print("%s", Text);
+        }
+
+        double BatteryVoltage()
+        {
+            return m_Brain.Battery.voltage(vex::voltageUnits::volt);
+        }
+};
+#endif
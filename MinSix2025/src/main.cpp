@@ -1,184 +1,323 @@
-/*----------------------------------------------------------------------------*/
-/*                                                                            */
-/*    Module:       MinSix2025_Auto.cpp                                                  */
-/*    Author:       Raiford G. Bonnell                                                    */
-/*    Created:      3/28/2025, 7:51:13 PM                                     */
-/*    Description:  IQ2 project                                               */
-/*                                                                            */
-/*----------------------------------------------------------------------------*/
-#include "vex.h"
-#include "MinSixAutoDrivetrain.h"
-
-using namespace vex;
-
-//Brain and PORT configuration
-vex::brain gBrain;
-vex::inertial gBrainInertial;
-vex::motor gRightDriveMotor(PORT12, false);
-vex::motor gLeftDriveMotor(PORT6, true);
-Min6AutoDrivetrain gDrivetrain(gBrain, gBrainInertial, gRightDriveMotor, gLeftDriveMotor);
-vex::touchled gSelectStopLed(PORT10);
-vex::touchled gStartLed(PORT11);
-vex::optical gFrontOptical(PORT1);
-vex::distance gDistance(PORT7);
-
-//Globals
-enum StatesOfBot 
-{
-    LOW_BATTERY,
-    READY,
-    RUNNING
-};
-StatesOfBot gBotState = StatesOfBot::LOW_BATTERY;
-
-enum RoutinsToRun
-{
-    Routine_None,
-    Routine_1,
-    Routine_2
-};
-RoutinsToRun gRoutin = RoutinsToRun::Routine_None;
-
-//Define Functions
-void SelectStop_Pressed();
-void Start_Pressed();
-void Routine_One();
-void Routine_Two();
-
-int main() 
-{
-    //Setup touch leds eventhandlers
-    gSelectStopLed.pressed(SelectStop_Pressed);
-    gStartLed.pressed(Start_Pressed);
-
-    //Check Battery Level
-    if (gBrain.Battery.capacity() >= 80)
-        gBotState = StatesOfBot::READY;
-    
-    //If battery is low play siren until overridden
-    if (gBotState == StatesOfBot::LOW_BATTERY)
-    {
-        gSelectStopLed.setColor(vex::colorType::red);
-        printf("Battery Level at %d%", gBrain.Battery.capacity());
-        while(true)
-        {
-            gBrain.playSound(vex::soundType::siren);
-            wait(1.0f, vex::timeUnits::sec);
-            if (gBotState == StatesOfBot::READY)
-                break;
-        }
-        printf("Low battery override!");
-    }
-    gSelectStopLed.setColor(vex::colorType::white);
-    gStartLed.setColor(vex::colorType::none);
-
-    //Configure drivetrain
-    gDrivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::Verbose);
-    gDrivetrain.Set_MAX_MOTOR_RPM(110.0f);
-    gDrivetrain.Set_MINIMAL_MOTOR_RPM(5.0f);
-    gDrivetrain.Set_WHEEL_CIRCUMFERENCE(230.0f);
-    gDrivetrain.Set_IN_GEAR_SIZE(48);
-    gDrivetrain.Set_OUT_GEAR_SIZE(24);
-    gDrivetrain.CalibrateGyro();
-   
-    while(1) 
-    {    
-        // Allow other tasks to run
-        this_thread::sleep_for(100);
-    }
-}
-
-#pragma region Handlers
-void SelectStop_Pressed()
-{
-    printf("Select/Stop Pressed\n");
-    if (gBotState == StatesOfBot::READY)
-    { 
-        switch (gRoutin)
-        {
-            case RoutinsToRun::Routine_None:
-                gSelectStopLed.setColor(vex::colorType::blue);
-                gStartLed.setColor(vex::colorType::green);
-                gRoutin = RoutinsToRun::Routine_1;
-                break;
-            case RoutinsToRun::Routine_1:
-                gSelectStopLed.setColor(vex::colorType::orange);
-                gStartLed.setColor(vex::colorType::green);
-                gRoutin = RoutinsToRun::Routine_2;
-                break;
-            case RoutinsToRun::Routine_2:
-                gRoutin = RoutinsToRun::Routine_None;
-                gStartLed.setColor(vex::colorType::none);
-                gSelectStopLed.setColor(vex::colorType::white);
-                break;
-        }
-    }
-    else if (gBotState == StatesOfBot::RUNNING)
-    {
-        gRoutin = RoutinsToRun::Routine_None;
-        gSelectStopLed.setColor(vex::colorType::white);
-        gBotState = StatesOfBot::READY;
-    }
-    else 
-    {
-        gBotState = StatesOfBot::READY;
-    }
-}
-
-void Start_Pressed()
-{
-    printf("Start Pressed\n");
-    if (gBotState == StatesOfBot::READY)
-    {
-        switch (gRoutin)
-        {
-            case RoutinsToRun::Routine_1:
-                gBotState = StatesOfBot::RUNNING;
-                gStartLed.setColor(vex::colorType::none);
-                gSelectStopLed.setColor(vex::colorType::red);
-                Routine_One();
-                gStartLed.setColor(vex::colorType::green);
-                gSelectStopLed.setColor(vex::colorType::blue);
-                gBotState = StatesOfBot::READY;
-                break;
-            case RoutinsToRun::Routine_2:
-                gBotState = StatesOfBot::RUNNING;
-                gStartLed.setColor(vex::colorType::none);
-                gSelectStopLed.setColor(vex::colorType::red);
-                Routine_Two();
-                gStartLed.setColor(vex::colorType::green);
-                gSelectStopLed.setColor(vex::colorType::orange);
-                gBotState = StatesOfBot::READY;
-                break;
-            case RoutinsToRun::Routine_None:
-                gStartLed.setColor(vex::colorType::none);
-                gSelectStopLed.setColor(vex::colorType::white);
-                break;
-        }
-    }
-}
-#pragma endregion
-
-#pragma region Routins
-void Routine_One()
-{
-    gBrain.Screen.setCursor(3, 1);
-    gBrain.Screen.print("Running 1");
-    gDrivetrain.TurnToHeading(90.0f, 50.0f, 5.0f, 0.1f);
-    gBrain.Screen.setCursor(3, 10);
-    gBrain.Screen.clearLine();
-
-    return;
-}
-
-void Routine_Two()
-{
-    gBrain.Screen.setCursor(3, 1);
-    gBrain.Screen.print("Running 2");
-    gDrivetrain.TurnToHeading(270.0f, 50.0f, 5.0f, 0.1f);
-    gBrain.Screen.setCursor(3, 10);
-    gBrain.Screen.clearLine();
-
-    return;
-}
-#pragma endregion
\ No newline at end of file
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       MinSix2025_Auto.cpp                                                  */
+/*    Author:       Raiford G. Bonnell                                                    */
+/*    Created:      3/28/2025, 7:51:13 PM                                     */
+/*    Description:  IQ2 project                                               */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#include <atomic>
+#include "vex.h"
+#include "VexHardware.h"
+#include "MinSixAutoDrivetrain.h"
+#include "MinSixConfig.h"
+#ifdef TICK_BENCHMARK
+#include "TickBenchmark.h"
+#endif
+
+using namespace vex;
+
+//Brain and PORT configuration
+vex::brain gBrain;
+vex::inertial gBrainInertial;
+vex::motor gRightDriveMotor(PORT12, false);
+vex::motor gLeftDriveMotor(PORT6, true);
+VexBrainHardware gBrainHardware(gBrain);
+VexInertialSensor gInertialHardware(gBrainInertial);
+VexDriveMotor gRightDriveHardware(gRightDriveMotor);
+VexDriveMotor gLeftDriveHardware(gLeftDriveMotor);
+Min6AutoDrivetrain gDrivetrain(gBrainHardware, gInertialHardware, gRightDriveHardware, gLeftDriveHardware, gMinSixConfig);
+vex::touchled gSelectStopLed(PORT10);
+vex::touchled gStartLed(PORT11);
+vex::optical gFrontOptical(PORT1);
+vex::distance gDistance(PORT7);
+VexOpticalSensor gFrontOpticalHardware(gFrontOptical);
+VexDistanceSensor gDistanceHardware(gDistance);
+VexTouchLed gSelectStopLedHardware(gSelectStopLed);
+VexTouchLed gStartLedHardware(gStartLed);
+StatusDisplay gStatus(gBrainHardware);
+LoopProfiler gLoopProfiler(gBrainHardware);
+
+//Globals
+enum StatesOfBot 
+{
+    LOW_BATTERY,
+    READY,
+    RUNNING
+};
+StatesOfBot gBotState = StatesOfBot::LOW_BATTERY;
+//StatusDisplay LED slots, screen row 1 is the gyro status from the drivetrain
+enum StatusLeds
+{
+    SelectStopStatusLed,
+    StartStatusLed
+};
+const int RoutineStatusRow = 3;
+//Battery: the gains are tuned on a pack at BatteryNominalVolts, the drivetrain compensates down to BatteryFloorVolts
+const float BatteryNominalVolts = 8.0f;
+const float BatteryFloorVolts = 7.0f;
+
+//Define Functions
+bool PathClear();
+
+//Routine tables, Select/Stop steps through them in order
+const RoutineStep gRoutineOneSteps[] =
+{
+    TurnStep(90.0f, 50.0f, 5.0f, 0.1f)
+};
+const RoutineStep gRoutineTwoSteps[] =
+{
+    TurnStep(270.0f, 50.0f, 5.0f, 0.1f)
+};
+const RoutineStep gRoutineThreeSteps[] =
+{
+    DriveStep(400.0f, 60.0f, 4.0f),
+    DriveStep(300.0f, 40.0f, 4.0f),
+    TurnStep(180.0f, 50.0f, 3.0f, 0.5f),
+    WaitUntilStep(PathClear, 2.0f),
+    DriveStep(700.0f, 60.0f, 5.0f)
+};
+const RoutineStep gRoutineFourSteps[] =
+{
+    DriveUntilStep(LineTrigger(50.0f), 900.0f, 60.0f, 4.0f),
+    TurnStep(90.0f, 50.0f, 3.0f, 0.5f),
+    DriveUntilStep(StandoffTrigger(150.0f), 1200.0f, 60.0f, 5.0f)
+};
+//Waypoints back to the start for Routine 5, in the pose frame: X to the right, Y ahead of the start position
+const PathPoint gHomePath[] =
+{
+    {600.0, 300.0},
+    {300.0, 0.0},
+    {0.0, 0.0}
+};
+const RoutineStep gRoutineFiveSteps[] =
+{
+    DriveStep(400.0f, 60.0f, 3.0f),
+    ArcStep(200.0f, 90.0f, 60.0f, 3.0f),
+    DriveStep(200.0f, 60.0f, 3.0f),
+    PathStep(gHomePath, sizeof(gHomePath) / sizeof(PathPoint), 60.0f, 150.0f, 8.0f)
+};
+const RoutineTable gRoutines[] =
+{
+    {"Routine 1", gRoutineOneSteps, sizeof(gRoutineOneSteps) / sizeof(RoutineStep)},
+    {"Routine 2", gRoutineTwoSteps, sizeof(gRoutineTwoSteps) / sizeof(RoutineStep)},
+    {"Routine 3", gRoutineThreeSteps, sizeof(gRoutineThreeSteps) / sizeof(RoutineStep)},
+    {"Routine 4", gRoutineFourSteps, sizeof(gRoutineFourSteps) / sizeof(RoutineStep)},
+    {"Routine 5", gRoutineFiveSteps, sizeof(gRoutineFiveSteps) / sizeof(RoutineStep)}
+};
+const int gRoutineCount = sizeof(gRoutines) / sizeof(RoutineTable);
+//Select/Stop LED colour of each routine when selected. White (none selected) and Red (running) are taken.
+const IStatusLed::Colors gRoutineColors[] = { IStatusLed::Blue, IStatusLed::Orange, IStatusLed::Purple, IStatusLed::Yellow, IStatusLed::Green };
+static_assert(sizeof(gRoutineColors) / sizeof(gRoutineColors[0]) == sizeof(gRoutines) / sizeof(RoutineTable), "Every routine needs its own LED colour");
+const int Routine_None = -1;
+int gRoutin = Routine_None;     //Index into gRoutines
+std::atomic<bool> gStartRequested(false);   //Set by Start_Pressed on the event task, the routine runs on the main task so the LED handlers stay responsive
+std::atomic<uint32_t> gRunId(0);            //Bumped by every Start, a cancelled routine still draining leaves a newer run alone
+
+void SelectStop_Pressed();
+void Start_Pressed();
+void SetRoutineLeds();
+void RunRoutine();
+
+#ifdef TICK_BENCHMARK
+//Brain kernel costs from an earlier run: paste the table the benchmark prints, 0 = not measured yet
+const TickBenchmarkBaseline gTickBaselines[] =
+{
+    {"MotionAccelerator", 0},
+    {"PIDController", 0},
+    {"HeadingError", 0},
+    {"MotionProfile", 0},
+    {"TurnTick", 0},
+    {"ProfiledTurnTick", 0}
+};
+TickBenchmark gTickBenchmark(gBrainHardware);
+
+/// @brief Time the controller kernels on the brain and flag any more than 10% slower than gTickBaselines
+void RunTickBenchmark()
+{
+    gStatus.SetRow(1, "Tick benchmark");
+    gStatus.Render();
+    gTickBenchmark.Run(20000, 5);
+    int regressions = gTickBenchmark.Report(gTickBaselines, sizeof(gTickBaselines) / sizeof(TickBenchmarkBaseline), 0.10);
+    gTickBenchmark.PrintBaselineTable();
+    gTickBenchmark.PrintLoopProfile();
+    gStatus.SetRow(1, "Tick bench: %d slower", regressions);
+}
+#endif
+
+int main() 
+{
+    //Screen and touch LEDs are drawn by a low priority task, everything else only updates gStatus
+    gStatus.Set_LED(SelectStopStatusLed, gSelectStopLedHardware);
+    gStatus.Set_LED(StartStatusLed, gStartLedHardware);
+
+#ifdef TICK_BENCHMARK
+    //Add -DTICK_BENCHMARK to DEFINES in vex/mkenv.mk to time the controller on the brain before any task starts
+    RunTickBenchmark();
+#endif
+
+    //Configure drivetrain
+    gDrivetrain.Set_LogLevel(Min6AutoDrivetrain::LogLevels::Verbose);
+    gDrivetrain.Set_TURN_PID(1.0f, 0.0f, 0.1f);
+    gDrivetrain.Set_DRIVE_PID(0.1f, 0.0f, 0.01f);
+    //kV from the drive geometry and kA for about 80ms of motor lag until CharacterizeTurn/CharacterizeDrive are run on the field
+    gDrivetrain.Set_TURN_FEEDFORWARD(5.0f, 0.0f, 0.016f);
+    gDrivetrain.Set_DRIVE_FEEDFORWARD(5.0f, 0.0f, 0.011f);
+    gDrivetrain.Set_HEADING_HOLD_PID(3.0f, 0.0f, 0.0f);
+    gDrivetrain.Set_BATTERY_COMPENSATION(BatteryNominalVolts, BatteryFloorVolts);
+    gDrivetrain.Set_FRONT_DISTANCE_SENSOR(gDistanceHardware);
+    gDrivetrain.Set_FRONT_OPTICAL_SENSOR(gFrontOpticalHardware);
+    gDrivetrain.Set_STATUS_DISPLAY(gStatus);
+    gDrivetrain.Set_LOOP_PROFILER(&gLoopProfiler);
+    gStatus.Start(100);
+
+    //Calibrate the gyro in the background while the battery check and LED setup run
+    gDrivetrain.StartGyroCalibration();
+
+    //Setup touch leds eventhandlers
+    gSelectStopLed.pressed(SelectStop_Pressed);
+    gStartLed.pressed(Start_Pressed);
+
+    //Check Battery Level: motion timing holds down to the compensation floor
+    if (gBrain.Battery.voltage(vex::voltageUnits::volt) >= (double)BatteryFloorVolts)
+        gBotState = StatesOfBot::READY;
+    
+    //If battery is low play siren until overridden
+    if (gBotState == StatesOfBot::LOW_BATTERY)
+    {
+        gStatus.SetLed(SelectStopStatusLed, IStatusLed::Red);
+        printf("Battery Level at %d%%", gBrain.Battery.capacity());
+        printf(" %f V\n", gBrain.Battery.voltage(vex::voltageUnits::volt));
+        while(true)
+        {
+            gBrain.playSound(vex::soundType::siren);
+            wait(1.0f, vex::timeUnits::sec);
+            if (gBotState == StatesOfBot::READY)
+                break;
+        }
+        printf("Low battery override!");
+    }
+    gStatus.SetLed(SelectStopStatusLed, IStatusLed::White);
+    gStatus.SetLed(StartStatusLed, IStatusLed::Off);
+
+    gDrivetrain.StartTelemetryTask();
+    gDrivetrain.StartMotionTask();
+    gDrivetrain.StartOdometryTask();
+   
+    while(1) 
+    {    
+        //A start pressed during calibration runs once the gyro is ready
+        if (gDrivetrain.IsGyroReady() && gStartRequested.exchange(false))
+            RunRoutine();
+
+        // Allow other tasks to run
+        this_thread::sleep_for(20);
+    }
+}
+
+/// @brief Run the selected routine, then restore the ready LEDs
+void RunRoutine()
+{
+    if (gRoutin == Routine_None) return;
+    uint32_t runId = gRunId;
+    const RoutineTable &routine = gRoutines[gRoutin];
+    gStatus.SetRow(RoutineStatusRow, "Running %s", routine.Name);
+
+    //Every routine starts from the field origin on heading 0: zero the heading where the bot was placed,
+    //reusing the boot calibration and gyro bias instead of calibrating again
+    gDrivetrain.CalibrateGyro(true);
+    gDrivetrain.ResetPose();
+    MotionHandle run = gDrivetrain.RunRoutineAsync(routine);
+    while (!run.isDone())
+    {
+        //Other work can run here while the drivetrain task drives the routine
+        this_thread::sleep_for(20);
+    }
+    gStatus.ClearRow(RoutineStatusRow);
+    Pose pose = gDrivetrain.GetPose();
+    printf("Routine end pose: x %f mm, y %f mm, heading %f\n", (double)pose.X, (double)pose.Y, (double)pose.Heading);
+    printf("Battery %f V, compensation %f\n", gDrivetrain.GET_BatteryVoltage(), gDrivetrain.GET_BatteryCompensation());
+    gLoopProfiler.Dump();
+    gLoopProfiler.Reset();
+    if ((gBotState == StatesOfBot::RUNNING) && (gRunId == runId))
+    {
+        SetRoutineLeds();
+        gBotState = StatesOfBot::READY;
+    }
+}
+
+/// @brief Show the selected routine: Select/Stop colour per routine, Start green when there is one to run
+void SetRoutineLeds()
+{
+    if (gRoutin == Routine_None)
+    {
+        gStatus.SetLed(StartStatusLed, IStatusLed::Off);
+        gStatus.SetLed(SelectStopStatusLed, IStatusLed::White);
+        return;
+    }
+    gStatus.SetLed(StartStatusLed, IStatusLed::Green);
+    gStatus.SetLed(SelectStopStatusLed, gRoutineColors[gRoutin]);
+}
+
+#pragma region Handlers
+void SelectStop_Pressed()
+{
+    printf("Select/Stop Pressed\n");
+    if (gBotState == StatesOfBot::READY)
+    { 
+        //Step to the next routine table, then back to none after the last
+        gRoutin++;
+        if (gRoutin >= gRoutineCount) gRoutin = Routine_None;
+        SetRoutineLeds();
+    }
+    else if (gBotState == StatesOfBot::RUNNING)
+    {
+        //Stop the drivetrain within one control tick, the routine sees the state change and returns. A start still
+        //waiting for the gyro is dropped, or the next routine selected would start on its own.
+        gStartRequested = false;
+        gDrivetrain.CancelAllMotion();
+        gRoutin = Routine_None;
+        gStatus.SetLed(StartStatusLed, IStatusLed::Off);
+        gStatus.SetLed(SelectStopStatusLed, IStatusLed::White);
+        gBotState = StatesOfBot::READY;
+    }
+    else 
+    {
+        gBotState = StatesOfBot::READY;
+    }
+}
+
+void Start_Pressed()
+{
+    printf("Start Pressed\n");
+    if (gBotState == StatesOfBot::READY)
+    {
+        if (gRoutin != Routine_None)
+        {
+            gRunId++;
+            gBotState = StatesOfBot::RUNNING;
+            gStatus.SetLed(StartStatusLed, IStatusLed::Off);
+            gStatus.SetLed(SelectStopStatusLed, IStatusLed::Red);
+            gStartRequested = true;
+            if (!gDrivetrain.IsGyroReady())
+            {
+                printf("Waiting for gyro calibration\n");
+                gStatus.SetLed(StartStatusLed, IStatusLed::Yellow);
+            }
+        }
+        else
+        {
+            gStatus.SetLed(StartStatusLed, IStatusLed::Off);
+            gStatus.SetLed(SelectStopStatusLed, IStatusLed::White);
+        }
+    }
+}
+#pragma endregion
+
+#pragma region Routins
+/// @brief Routine condition: nothing within 300mm of the front of the bot
+bool PathClear()
+{
+    return !gDistance.isObjectDetected() || (gDistance.objectDistance(vex::distanceUnits::mm) > 300.0);
+}
+#pragma endregion